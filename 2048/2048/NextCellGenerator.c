@@ -7,11 +7,15 @@ typedef GameBoardCell (*GetTargetHandler)(NextCellGenerator *);
 
 struct NextCellGenerator {
     GameBoard *gb;
+    uint32_t numCols;
     uint32_t minRows;
     uint32_t minCols;
     GameBoardCell current;
     MoveNextHandler moveNext;
     GetTargetHandler getNextTarget;
+    uint32_t numPairs;
+    uint32_t next;
+    CellIndexPair pairs[];
 };
 
 static GameBoardCell HandleGetTargetUp(NextCellGenerator *gen) {
@@ -106,10 +110,30 @@ static int HandleMoveNextRight(NextCellGenerator *gen) {
     return 1;
 }
 
+// Walks the board once with the direction's handlers and keeps the result, so slides never have to
+// call back into them.
+static void BuildPairs(NextCellGenerator *gen) {
+    uint32_t rows = GameBoardNumRows(gen->gb);
+    if (gen->numCols < gen->minCols || rows < gen->minRows) {
+        return;
+    }
+    gen->current = GameBoardMakeCell(-1, -1);
+    while (gen->moveNext(gen)) {
+        GameBoardCell target = gen->getNextTarget(gen);
+        CellIndexPair pair = {
+            .source = gen->current.col + gen->current.row * gen->numCols,
+            .target = target.col + target.row * gen->numCols
+        };
+        gen->pairs[gen->numPairs++] = pair;
+    }
+}
+
 NextCellGenerator *CellGeneratorCreate(GameBoard *gameBoard, SlideDirection direction) {
     LOG_ASSERTMSG_REASON(gameBoard, "gameboard", ArgumentNullReason);
-    NextCellGenerator *gen = calloc(1, sizeof(NextCellGenerator));
+    uint32_t numCells = GameBoardNumRows(gameBoard) * GameBoardNumCols(gameBoard);
+    NextCellGenerator *gen = calloc(1, sizeof(NextCellGenerator) + numCells * sizeof(CellIndexPair));
     gen->gb = gameBoard;
+    gen->numCols = GameBoardNumCols(gameBoard);
     gen->current = GameBoardMakeCell(-1, -1);
     switch(direction) {
         case SlideUp:
@@ -138,8 +162,9 @@ NextCellGenerator *CellGeneratorCreate(GameBoard *gameBoard, SlideDirection dire
             break;
         default:
             LOG_ASSERTMSG_REASON(0, "invalid slide direction!", ArgumentOutOfRangeReason);
-            break;
+            return gen;
     }
+    BuildPairs(gen);
     return gen;
 }
 
@@ -149,22 +174,28 @@ void CellGeneratorDispose(NextCellGenerator *generator) {
 }
 
 void CellGeneratorReset(NextCellGenerator *generator) {
-    generator->current = GameBoardMakeCell(-1, -1);
+    generator->next = 0;
 }
 
 int CellGeneratorMoveNext(NextCellGenerator *generator) {
-    LOG_ASSERT_REASON(generator && generator->gb && generator->moveNext, ArgumentNullReason);
-
-    uint32_t rows = GameBoardNumRows(generator->gb);
-    uint32_t cols = GameBoardNumCols(generator->gb);
-    if (cols < generator->minCols || rows < generator->minRows) {
+    LOG_ASSERT_REASON(generator && generator->gb, ArgumentNullReason);
+    if (generator->next == generator->numPairs) {
         return 0;
     }
-    return generator->moveNext(generator);
+    generator->next++;
+    return 1;
 }
 
 void CellGeneratorGetCurrent(NextCellGenerator *generator, GameBoardCell *toSlide, GameBoardCell *target) {
-    LOG_ASSERT_REASON(generator && generator->gb && generator->getNextTarget, ArgumentNullReason);
-    *toSlide = generator->current;
-    *target = generator->getNextTarget(generator);
+    LOG_ASSERT_REASON(generator && generator->gb, ArgumentNullReason);
+    LOG_ASSERT_REASON(generator->next, InvalidOperationReason);
+    CellIndexPair pair = generator->pairs[generator->next - 1];
+    *toSlide = GameBoardMakeCell(pair.source / generator->numCols, pair.source % generator->numCols);
+    *target = GameBoardMakeCell(pair.target / generator->numCols, pair.target % generator->numCols);
+}
+
+uint32_t CellGeneratorGetPairs(NextCellGenerator *generator, const CellIndexPair **pairs) {
+    LOG_ASSERT_REASON(generator && pairs, ArgumentNullReason);
+    *pairs = generator->pairs;
+    return generator->numPairs;
 }
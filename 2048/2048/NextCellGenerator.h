@@ -10,12 +10,20 @@
 
 typedef struct NextCellGenerator NextCellGenerator;
 
+// Board indices (col + row * numCols) of a cell and the neighbour it slides into.
+typedef struct CellIndexPair {
+    uint32_t source;
+    uint32_t target;
+} CellIndexPair;
+
 NextCellGenerator *CellGeneratorCreate(GameBoard *gameBoard, SlideDirection direction);
 void CellGeneratorDispose(NextCellGenerator *generator);
 
 void CellGeneratorReset(NextCellGenerator *generator);
 int CellGeneratorMoveNext(NextCellGenerator *generator);
 void CellGeneratorGetCurrent(NextCellGenerator *generator, GameBoardCell *toSlide, GameBoardCell *target);
+// The whole traversal, worked out once when the generator is created. Returns the pair count.
+uint32_t CellGeneratorGetPairs(NextCellGenerator *generator, const CellIndexPair **pairs);
 
 #ifdef __cplusplus
     }
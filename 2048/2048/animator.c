@@ -0,0 +1,171 @@
+#include <ansi_c.h>
+#include "animator.h"
+#include "../../CVI_Core/log.h"
+
+// Frames this close to the end count as the end, so rounding in the caller's clock cannot leave
+// the animation one frame short.
+#define END_EPSILON 1e-6
+
+struct Animator {
+    uint32_t numRows;
+    uint32_t numCols;
+    double duration;
+    double start;
+    int running;
+    AnimatedTile *tiles;
+    uint32_t numTiles;
+    uint32_t *cells;
+    uint32_t numCells;
+    uint8_t *cellUsed;
+    uint8_t *mergeTarget;
+};
+
+static uint32_t CellIndex(Animator *animator, GameBoardCell cell) {
+    return cell.col + cell.row * animator->numCols;
+}
+
+static void AddCell(Animator *animator, int row, int col) {
+    uint32_t idx = col + row * animator->numCols;
+    if (!animator->cellUsed[idx]) {
+        animator->cellUsed[idx] = 1;
+        animator->cells[animator->numCells++] = idx;
+    }
+}
+
+// Slides only ever run along a row or a column, so the path is every cell between the two ends.
+static void AddPath(Animator *animator, GameBoardCell from, GameBoardCell to) {
+    int rowStep = from.row < to.row ? 1 : from.row > to.row ? -1 : 0;
+    int colStep = from.col < to.col ? 1 : from.col > to.col ? -1 : 0;
+    GameBoardCell cell = from;
+    AddCell(animator, cell.row, cell.col);
+    while (cell.row != to.row || cell.col != to.col) {
+        cell.row += rowStep;
+        cell.col += colStep;
+        AddCell(animator, cell.row, cell.col);
+    }
+}
+
+static void AddTile(Animator *animator, GameBoardCell from, GameBoardCell to, uint8_t exponent, double scale) {
+    AnimatedTile tile = { .from = from, .to = to, .exponent = exponent, .progress = 0, .scale = scale };
+    animator->tiles[animator->numTiles++] = tile;
+}
+
+// Fast at first and settling into place.
+static double EaseOut(double t) {
+    return 1 - (1 - t) * (1 - t);
+}
+
+Animator *AnimatorCreate(uint32_t numRows, uint32_t numCols, double duration) {
+    LOG_ASSERT_REASON(numRows && numCols, ArgumentOutOfRangeReason);
+    LOG_ASSERT_REASON(duration > 0, ArgumentOutOfRangeReason);
+
+    uint32_t numCells = numRows * numCols;
+    Animator *animator = calloc(1, sizeof(Animator));
+    animator->numRows = numRows;
+    animator->numCols = numCols;
+    animator->duration = duration;
+    // A merged cell can add one stationary tile on top of the moves and merges.
+    animator->tiles = calloc(numCells * 2, sizeof(AnimatedTile));
+    animator->cells = calloc(numCells, sizeof(uint32_t));
+    animator->cellUsed = calloc(numCells, sizeof(uint8_t));
+    animator->mergeTarget = calloc(numCells, sizeof(uint8_t));
+    return animator;
+}
+
+void AnimatorDispose(Animator *animator) {
+    LOG_ASSERT_REASON(animator, ArgumentNullReason);
+    free(animator->tiles);
+    free(animator->cells);
+    free(animator->cellUsed);
+    free(animator->mergeTarget);
+    free(animator);
+}
+
+void AnimatorStart(Animator *animator, const BoardDiff *diff, double now) {
+    LOG_ASSERT_REASON(animator && diff, ArgumentNullReason);
+
+    uint32_t numCells = animator->numRows * animator->numCols;
+    memset(animator->cellUsed, 0, numCells);
+    memset(animator->mergeTarget, 0, numCells);
+    animator->numTiles = 0;
+    animator->numCells = 0;
+    animator->start = now;
+
+    // Both halves of a merge travel showing the old value; the doubled value appears at the end.
+    for (uint32_t i = 0; i < diff->numChanges; i++) {
+        const BoardChange *change = &diff->changes[i];
+        if (change->kind == BoardChangeMerge) {
+            animator->mergeTarget[CellIndex(animator, change->to)] = 1;
+            AddTile(animator, change->from, change->to, change->exponent - 1, 1);
+            AddPath(animator, change->from, change->to);
+        }
+    }
+    for (uint32_t i = 0; i < diff->numChanges; i++) {
+        const BoardChange *change = &diff->changes[i];
+        uint32_t to = CellIndex(animator, change->to);
+        switch (change->kind) {
+            case BoardChangeMove:
+                AddTile(animator, change->from, change->to, animator->mergeTarget[to] ? change->exponent - 1 : change->exponent, 1);
+                AddPath(animator, change->from, change->to);
+                // Marks the consumer as handled, so it is not added again as a stationary tile.
+                animator->mergeTarget[to] = 2;
+                break;
+            case BoardChangeAdd:
+                AddTile(animator, change->to, change->to, change->exponent, 0);
+                AddCell(animator, change->to.row, change->to.col);
+                break;
+            case BoardChangeRemove:
+                AddCell(animator, change->to.row, change->to.col);
+                break;
+            case BoardChangeMerge:
+                break;
+        }
+    }
+    for (uint32_t i = 0; i < diff->numChanges; i++) {
+        const BoardChange *change = &diff->changes[i];
+        uint32_t to = CellIndex(animator, change->to);
+        if (change->kind == BoardChangeMerge && animator->mergeTarget[to] == 1) {
+            AddTile(animator, change->to, change->to, change->exponent - 1, 1);
+            animator->mergeTarget[to] = 2;
+        }
+    }
+
+    animator->running = animator->numCells != 0;
+}
+
+void AnimatorFinish(Animator *animator) {
+    LOG_ASSERT_REASON(animator, ArgumentNullReason);
+    animator->running = 0;
+}
+
+int AnimatorIsRunning(Animator *animator) {
+    LOG_ASSERT_REASON(animator, ArgumentNullReason);
+    return animator->running;
+}
+
+uint32_t AnimatorGetCells(Animator *animator, const uint32_t **cells) {
+    LOG_ASSERT_REASON(animator && cells, ArgumentNullReason);
+    *cells = animator->cells;
+    return animator->numCells;
+}
+
+uint32_t AnimatorGetFrame(Animator *animator, double now, const AnimatedTile **tiles) {
+    LOG_ASSERT_REASON(animator && tiles, ArgumentNullReason);
+
+    double t = (now - animator->start) / animator->duration;
+    t = t < 0 ? 0 : t > 1 - END_EPSILON ? 1 : t;
+    double progress = EaseOut(t);
+    for (uint32_t i = 0; i < animator->numTiles; i++) {
+        AnimatedTile *tile = &animator->tiles[i];
+        tile->progress = progress;
+        if (tile->from.row == tile->to.row && tile->from.col == tile->to.col && tile->scale < 1) {
+            tile->scale = progress;
+        }
+    }
+    if (t >= 1) {
+        animator->running = 0;
+    }
+
+    *tiles = animator->tiles;
+    return animator->numTiles;
+}
@@ -0,0 +1,46 @@
+#ifndef __animator_H__
+#define __animator_H__
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#include <stdint.h>
+#include "cvidef.h"
+#include "gameboard.h"
+
+// One tile in flight. Renderers place it progress of the way from the from cell to the to cell and
+// draw it at scale (spawns grow in, everything else is 1).
+typedef struct AnimatedTile {
+    GameBoardCell from;
+    GameBoardCell to;
+    uint8_t exponent;
+    double progress;
+    double scale;
+} AnimatedTile;
+
+// Turns a BoardDiff into the frames of a slide. It knows nothing about drawing or clocks: callers
+// pass the current time and draw whatever the frame describes, so a late frame simply lands further
+// along instead of holding anything up.
+typedef struct Animator Animator;
+
+Animator *AnimatorCreate(uint32_t numRows, uint32_t numCols, double duration);
+void AnimatorDispose(Animator *animator);
+
+// Replaces any running animation; callers should redraw the old one's cells in their final state.
+void AnimatorStart(Animator *animator, const BoardDiff *diff, double now);
+void AnimatorFinish(Animator *animator);
+int AnimatorIsRunning(Animator *animator);
+
+// Every cell a tile passes over. Renderers clear these each frame before drawing the tiles, and
+// draw them from the board once the animation ends.
+uint32_t AnimatorGetCells(Animator *animator, const uint32_t **cells);
+// Moves the animation to time now and returns the tiles to draw, bottom first. The animation stops
+// running once a frame reaches the end.
+uint32_t AnimatorGetFrame(Animator *animator, double now, const AnimatedTile **tiles);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif  /* ndef __animator_H__ */
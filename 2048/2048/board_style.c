@@ -0,0 +1,78 @@
+#include <ansi_c.h>
+#include "board_style.h"
+#include "../../CVI_Core/log.h"
+
+#define LARGE_TILE_COLOR 0x3C3A32
+
+// Indexed by tile exponent; 0 is an empty cell.
+static const int tileColors[] = {
+    0xCDC0B4, 0xEEE4DA, 0xEDE0C8, 0xF2B179, 0xF59563, 0xF67C5F,
+    0xF65D3B, 0xEDCE71, 0xEDCC61, 0xECC850, 0xEDC53F, 0xEEC22E
+};
+
+// Exact values while they stay short enough to read on a tile, powers of two after that.
+static const char *const tileTexts[TILE_MAX_EXPONENT + 1] = {
+    "", "2", "4", "8", "16", "32", "64", "128", "256", "512", "1024", "2048", "4096", "8192",
+    "16384", "32768", "65536", "131072", "262144", "524288", "1048576", "2^21", "2^22", "2^23",
+    "2^24", "2^25", "2^26", "2^27", "2^28", "2^29", "2^30", "2^31", "2^32", "2^33", "2^34", "2^35",
+    "2^36", "2^37", "2^38", "2^39", "2^40", "2^41", "2^42", "2^43", "2^44", "2^45", "2^46", "2^47",
+    "2^48", "2^49", "2^50", "2^51", "2^52", "2^53", "2^54", "2^55", "2^56", "2^57", "2^58", "2^59",
+    "2^60", "2^61", "2^62", "2^63", "2^64", "2^65", "2^66", "2^67", "2^68", "2^69", "2^70", "2^71",
+    "2^72", "2^73", "2^74", "2^75", "2^76", "2^77", "2^78", "2^79", "2^80", "2^81", "2^82", "2^83",
+    "2^84", "2^85", "2^86", "2^87", "2^88", "2^89", "2^90", "2^91", "2^92", "2^93", "2^94", "2^95",
+    "2^96", "2^97", "2^98", "2^99", "2^100", "2^101", "2^102", "2^103", "2^104", "2^105", "2^106",
+    "2^107", "2^108", "2^109", "2^110", "2^111", "2^112", "2^113", "2^114", "2^115", "2^116",
+    "2^117", "2^118", "2^119", "2^120", "2^121", "2^122", "2^123", "2^124", "2^125", "2^126",
+    "2^127", "2^128", "2^129", "2^130", "2^131", "2^132", "2^133", "2^134", "2^135", "2^136",
+    "2^137", "2^138", "2^139", "2^140", "2^141", "2^142", "2^143", "2^144", "2^145", "2^146",
+    "2^147", "2^148", "2^149", "2^150", "2^151", "2^152", "2^153", "2^154", "2^155", "2^156",
+    "2^157", "2^158", "2^159", "2^160", "2^161", "2^162", "2^163", "2^164", "2^165", "2^166",
+    "2^167", "2^168", "2^169", "2^170", "2^171", "2^172", "2^173", "2^174", "2^175", "2^176",
+    "2^177", "2^178", "2^179", "2^180", "2^181", "2^182", "2^183", "2^184", "2^185", "2^186",
+    "2^187", "2^188", "2^189", "2^190", "2^191", "2^192", "2^193", "2^194", "2^195", "2^196",
+    "2^197", "2^198", "2^199", "2^200", "2^201", "2^202", "2^203", "2^204", "2^205", "2^206",
+    "2^207", "2^208", "2^209", "2^210", "2^211", "2^212", "2^213", "2^214", "2^215", "2^216",
+    "2^217", "2^218", "2^219", "2^220", "2^221", "2^222", "2^223", "2^224", "2^225", "2^226",
+    "2^227", "2^228", "2^229", "2^230", "2^231", "2^232", "2^233", "2^234", "2^235", "2^236",
+    "2^237", "2^238", "2^239", "2^240", "2^241", "2^242", "2^243", "2^244", "2^245", "2^246",
+    "2^247", "2^248", "2^249", "2^250", "2^251", "2^252", "2^253", "2^254", "2^255"
+};
+
+BoardStyleRect BoardStyleTileRect(uint32_t numRows, uint32_t numCols, int height, int width, uint32_t row, uint32_t col) {
+    LOG_ASSERT_REASON(row < numRows && col < numCols, ArgumentOutOfRangeReason);
+
+    int colMarginWidth = (numCols + 1) * BOARD_STYLE_PADDING;
+    int rowMarginWidth = (numRows + 1) * BOARD_STYLE_PADDING;
+    int tileWidth = (width - colMarginWidth) / (int)numCols;
+    int tileHeight = (height - rowMarginWidth) / (int)numRows;
+    int leftOverWidth = width - (tileWidth * (int)numCols + colMarginWidth);
+    int leftOverHeight = height - (tileHeight * (int)numRows + rowMarginWidth);
+
+    BoardStyleRect r;
+    r.top = tileHeight * row + (row + 1) * BOARD_STYLE_PADDING + leftOverHeight / 2;
+    r.left = tileWidth * col + (col + 1) * BOARD_STYLE_PADDING + leftOverWidth / 2;
+    r.height = tileHeight;
+    r.width = tileWidth;
+    return r;
+}
+
+BoardStyleRect BoardStyleTextRect(BoardStyleRect tileRect) {
+    BoardStyleRect r;
+    r.top = tileRect.top + BOARD_STYLE_TEXT_INSET;
+    r.left = tileRect.left + BOARD_STYLE_TEXT_INSET;
+    r.height = tileRect.height - BOARD_STYLE_TEXT_INSET * 2;
+    r.width = tileRect.width - BOARD_STYLE_TEXT_INSET * 2;
+    return r;
+}
+
+int BoardStyleTileColor(uint8_t exponent) {
+    return exponent < sizeof(tileColors) / sizeof(tileColors[0]) ? tileColors[exponent] : LARGE_TILE_COLOR;
+}
+
+int BoardStyleTextColor(uint8_t exponent) {
+    return exponent > 2 ? 0xF6F7FB : 0x756C65;
+}
+
+const char *BoardStyleTileText(uint8_t exponent) {
+    return tileTexts[exponent];
+}
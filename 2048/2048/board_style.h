@@ -0,0 +1,38 @@
+#ifndef __board_style_H__
+#define __board_style_H__
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#include <stdint.h>
+#include "cvidef.h"
+#include "tile.h"
+
+// The look of the board, shared by every renderer so they all lay tiles out and colour them alike.
+#define BOARD_STYLE_BACKGROUND 0xBBADA0
+#define BOARD_STYLE_PADDING 6
+#define BOARD_STYLE_TEXT_INSET 2
+#define BOARD_STYLE_CORNER_RADIUS 6
+
+typedef struct BoardStyleRect {
+    int top;
+    int left;
+    int height;
+    int width;
+} BoardStyleRect;
+
+// Tiles share the canvas evenly, with any leftover pixels split around the edges.
+BoardStyleRect BoardStyleTileRect(uint32_t numRows, uint32_t numCols, int height, int width, uint32_t row, uint32_t col);
+BoardStyleRect BoardStyleTextRect(BoardStyleRect tileRect);
+
+// All keyed by tile exponent, 0 being an empty cell. Colours are 0xRRGGBB.
+int BoardStyleTileColor(uint8_t exponent);
+int BoardStyleTextColor(uint8_t exponent);
+const char *BoardStyleTileText(uint8_t exponent);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif  /* ndef __board_style_H__ */
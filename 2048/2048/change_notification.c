@@ -1,93 +1,129 @@
 #include <ansi_c.h>
-#include "toolbox.h"
 #include "change_notification.h"
 #include "../../CVI_Core/log.h"
 
-static int CompareChangeData(void *item1, void *item2) {
-    ChangeData *data1 = (ChangeData *)item1;
-    ChangeData *data2 = (ChangeData *)item2;
-    
+static int IsSameListener(ChangeData *data1, ChangeData *data2) {
     return data1->target == data2->target && data1->handler == data2->handler;
 }
 
-static int Notify(int index, void *ptr, void *callbackData) {
-    ChangeData *data = *(ChangeData **)ptr;
-    LOG_ASSERT_REASON(data, ArgumentNullReason);
-    
-    data->handler(data->target, data->data);
-    return 0;
+static ListenerSlot *GetSlots(ListenerList *listeners) {
+    return listeners->heapSlots ? listeners->heapSlots : listeners->inlineSlots;
 }
 
-static ChangeData *CopyData(ChangeData *data) {
-    ChangeData *copy = calloc(1, sizeof(ChangeData));
-    copy->data = data->data;
-    copy->target = data->target;
-    copy->handler = data->handler;
-    
-    return copy;
+static void Grow(ListenerList *listeners) {
+    uint32_t capacity = listeners->heapSlots ? listeners->capacity * 2 : LISTENER_INLINE_CAPACITY * 2;
+    ListenerSlot *slots = malloc(capacity * sizeof(ListenerSlot));
+    memcpy(slots, GetSlots(listeners), listeners->numSlots * sizeof(ListenerSlot));
+    free(listeners->heapSlots);
+    listeners->heapSlots = slots;
+    listeners->capacity = capacity;
 }
 
-static void *RemoveHandlerAt(ListType *list, size_t idx) {
-    LOG_ASSERT_REASON(idx, ArgumentOutOfRangeReason);
-    
-    ChangeData *copy;
-    ListRemoveItem(*list, &copy, idx);
-    void *clientData = copy->data;
-    free(copy);
-    
-    if (!ListNumItems(*list)) {
-        ListDispose(*list);
-        *list = 0;
+static void ReleaseStorage(ListenerList *listeners) {
+    // lastGeneration survives so handles from before the release stay stale.
+    free(listeners->heapSlots);
+    listeners->heapSlots = 0;
+    listeners->capacity = 0;
+    listeners->count = 0;
+    listeners->numSlots = 0;
+    listeners->firstFree = 0;
+}
+
+static void *FreeSlot(ListenerList *listeners, uint32_t slot) {
+    ListenerSlot *s = GetSlots(listeners) + slot;
+    void *clientData = s->data.data;
+
+    // Free slots are chained through data.data, holding the next free slot + 1.
+    memset(s, 0, sizeof(ListenerSlot));
+    s->data.data = (void *)(uintptr_t)listeners->firstFree;
+    listeners->firstFree = slot + 1;
+
+    listeners->count--;
+    if (!listeners->count) {
+        ReleaseStorage(listeners);
     }
     return clientData;
 }
 
-void ChangeHandlerNotifyListeners(ListenerList listeners) {
-    ListType list = (ListType)listeners;
-    if (list) {
-        ListApplyToEach(list, 1, Notify, 0);
+void ChangeHandlerNotifyListeners(ListenerList *listeners, void *args) {
+    LOG_ASSERT_REASON(listeners, ArgumentNullReason);
+    // Slots are re-read every pass so handlers can add or remove listeners while we dispatch.
+    for (uint32_t i = 0; i < listeners->numSlots; i++) {
+        ListenerSlot *slot = GetSlots(listeners) + i;
+        if (slot->generation) {
+            slot->data.handler(slot->data.target, slot->data.data, args);
+        }
     }
 }
 
 void ChangeHandlerClear(ListenerList *listeners, ClearDataHandler handleClearData) {
     LOG_ASSERT_REASON(listeners, ArgumentNullReason);
-    if (!*listeners) {
-        return;
-    }
-    
-    ListType *list = (ListType *)listeners;
     
-    size_t idx = ListNumItems(*list);
-    while(idx) {
-        void *clientData = RemoveHandlerAt(list, idx);
-        if (handleClearData != 0) {
-            handleClearData(clientData);
+    ListenerSlot *slots = GetSlots(listeners);
+    if (handleClearData != 0) {
+        for (uint32_t i = 0; i < listeners->numSlots; i++) {
+            if (slots[i].generation) {
+                handleClearData(slots[i].data.data);
+            }
         }
-        idx = ListNumItems(*list);
     }
+    ReleaseStorage(listeners);
 }
 
-void ChangeHandlerAdd(ListenerList *listeners, ChangeData data) {
+ListenerHandle ChangeHandlerAdd(ListenerList *listeners, ChangeData data) {
     LOG_ASSERT_REASON(listeners, ArgumentNullReason);
-    ListType *listPtr = (ListType *)listeners;
-    ChangeData *copy = CopyData(&data);
-    
-    if (!*listPtr){
-        *listPtr = ListCreate(sizeof(copy));
+    LOG_ASSERT_REASON(data.handler, ArgumentNullReason);
+
+    uint32_t slot;
+    if (listeners->firstFree) {
+        slot = listeners->firstFree - 1;
+        listeners->firstFree = (uint32_t)(uintptr_t)GetSlots(listeners)[slot].data.data;
+    } else {
+        uint32_t capacity = listeners->heapSlots ? listeners->capacity : LISTENER_INLINE_CAPACITY;
+        if (listeners->numSlots == capacity) {
+            Grow(listeners);
+        }
+        slot = listeners->numSlots++;
     }
-    
-    ListInsertItem(*listPtr, &copy, END_OF_LIST);
+
+    // Zero marks a free slot, so skip it if the counter ever wraps.
+    if (!++listeners->lastGeneration) {
+        ++listeners->lastGeneration;
+    }
+    ListenerSlot *s = GetSlots(listeners) + slot;
+    s->data = data;
+    s->generation = listeners->lastGeneration;
+    listeners->count++;
+
+    ListenerHandle handle = { .slot = slot, .generation = s->generation };
+    return handle;
 }
 
 void *ChangeHandlerRemove(ListenerList *listeners, ChangeData data) {
     LOG_ASSERT_REASON(listeners, ArgumentNullReason);
     
-    if (!*listeners) {
+    ListenerSlot *slots = GetSlots(listeners);
+    for (uint32_t i = 0; i < listeners->numSlots; i++) {
+        if (slots[i].generation && IsSameListener(&slots[i].data, &data)) {
+            return FreeSlot(listeners, i);
+        }
+    }
+    return 0;
+}
+
+void *ChangeHandlerRemoveHandle(ListenerList *listeners, ListenerHandle handle) {
+    LOG_ASSERT_REASON(listeners, ArgumentNullReason);
+
+    if (!handle.generation || handle.slot >= listeners->numSlots) {
         return 0;
     }
-    
-    ListType *list = (ListType *)listeners;
-    
-    size_t idx = ListFindItem(*list, &data, FRONT_OF_LIST, CompareChangeData);
-    return RemoveHandlerAt(list, idx);
+    if (GetSlots(listeners)[handle.slot].generation != handle.generation) {
+        return 0;
+    }
+    return FreeSlot(listeners, handle.slot);
+}
+
+uint32_t ChangeHandlerCount(ListenerList *listeners) {
+    LOG_ASSERT_REASON(listeners, ArgumentNullReason);
+    return listeners->count;
 }
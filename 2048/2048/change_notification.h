@@ -5,10 +5,13 @@
     extern "C" {
 #endif
 
+#include <stdint.h>
 #include "cvidef.h"
 
-typedef void * ListenerList;
-typedef void (*ChangeHandler)(void *, void *);
+#define LISTENER_INLINE_CAPACITY 2
+
+// target and data are fixed when the listener is added; args is whatever the notifier passes for this notification.
+typedef void (*ChangeHandler)(void *target, void *data, void *args);
 typedef void (*ClearDataHandler)(void *);
         
 typedef struct ChangeData {
@@ -17,11 +20,38 @@ typedef struct ChangeData {
     ChangeHandler handler;
 } ChangeData;
 
+// Identifies one registration. Removing by handle is O(1), and a handle that has already been
+// removed (or whose slot has since been reused) is ignored.
+typedef struct ListenerHandle {
+    uint32_t slot;
+    uint32_t generation;
+} ListenerHandle;
+
+typedef struct ListenerSlot {
+    ChangeData data;
+    uint32_t generation;
+} ListenerSlot;
+
+// Listeners are stored by value in a contiguous array of slots. The first LISTENER_INLINE_CAPACITY
+// slots live inside the list itself; heapSlots is only allocated once a list outgrows them. A zeroed
+// ListenerList is a valid, empty list.
+typedef struct ListenerList {
+    ListenerSlot *heapSlots;
+    uint32_t count;
+    uint32_t numSlots;
+    uint32_t capacity;
+    uint32_t firstFree;
+    uint32_t lastGeneration;
+    ListenerSlot inlineSlots[LISTENER_INLINE_CAPACITY];
+} ListenerList;
+
 void ChangeHandlerClear(ListenerList *listeners, ClearDataHandler handler);
-void ChangeHandlerAdd(ListenerList *listeners, ChangeData data);
+ListenerHandle ChangeHandlerAdd(ListenerList *listeners, ChangeData data);
 void *ChangeHandlerRemove(ListenerList *listeners, ChangeData data);
+void *ChangeHandlerRemoveHandle(ListenerList *listeners, ListenerHandle handle);
+uint32_t ChangeHandlerCount(ListenerList *listeners);
 
-void ChangeHandlerNotifyListeners(ListenerList listeners);
+void ChangeHandlerNotifyListeners(ListenerList *listeners, void *args);
 
 #ifdef __cplusplus
     }
@@ -1,11 +1,38 @@
-#include "toolbox.h"
 #include <ansi_c.h>
 #include "controller.h"
+#include "history.h"
+#include "event_ring.h"
+#include "timer_wheel.h"
 #include "../../CVI_Core/log.h"
 
+#define TIMER_TICK .001
+#define SPAWN_DELAY .2
+
+typedef struct TileSubscription {
+    Tile *tile;
+    ListenerHandle handle;
+} TileSubscription;
+
 struct Controller {
     GameBoard *gameBoard;
     GameUpdateHandler *updateHandler;
+    GameHistory *history;
+    size_t snapshotSize;
+    void *currentSnapshot;
+    void *restoreSnapshot;
+    int spawnPending;
+    TimerWheel *timers;
+    TimerHandle spawnTimer;
+    SlideDirection input[CONTROLLER_INPUT_CAPACITY];
+    uint32_t inputStart;
+    uint32_t inputCount;
+    int collapseInput;
+    int usesDiffs;
+    ListenerHandle addRemoveHandle;
+    ListenerHandle diffHandle;
+    ListenerHandle resetHandle;
+    TileSubscription *tileSubscriptions;
+    GameEventRing *eventRing;
 };
 
 static void NotifyTileAddRemove(GameUpdateHandler *handler, Tile *tile, AddRemoveReason reason) {
@@ -24,6 +51,12 @@ static void NotifyTileValueChange(GameUpdateHandler *handler, Tile *tile) {
     }
 }
 
+static void NotifyGameReset(GameBoard *gameBoard, GameUpdateHandler *handler) {
+    if (handler != 0 && handler->handleGameReset != 0) {
+        handler->handleGameReset(handler->target, gameBoard);
+    }
+}
+
 static void NotifyBeginUpdate(GameBoard *gameBoard, GameUpdateHandler *handler) {
     if (handler != 0 && handler->beginUpdateGame != 0) {
         handler->beginUpdateGame(handler->target, gameBoard);
@@ -36,73 +69,346 @@ static void NotifyEndUpdate(GameBoard *gameBoard, GameUpdateHandler *handler) {
     }
 }
 
+static void PostEvent(Controller *controller, GameEventKind kind, GameBoardCell from, GameBoardCell to, uint8_t exponent) {
+    if (controller->eventRing != 0) {
+        GameEvent event = {
+            .kind = kind,
+            .from = from,
+            .to = to,
+            .exponent = exponent,
+            .score = GameBoardGetScore(controller->gameBoard)
+        };
+        GameEventRingPublish(controller->eventRing, &event);
+    }
+}
+
+static void PostUpdateEvent(Controller *controller, GameEventKind kind) {
+    GameBoardCell none = GameBoardMakeCell(-1, -1);
+    PostEvent(controller, kind, none, none, 0);
+}
+
+static void PostTileEvent(Controller *controller, GameEventKind kind, Tile *tile) {
+    GameBoardCell cell = GameBoardMakeCell(TileGetRow(tile), TileGetColumn(tile));
+    PostEvent(controller, kind, cell, cell, TileGetExponent(tile));
+}
+
 static void HandleTileValueChange(Tile *tile, void *data) {
     Controller *controller = (Controller *)data;
     GameUpdateHandler *handler = controller->updateHandler;
     NotifyTileValueChange(handler, tile);
+    PostTileEvent(controller, GameEventTileValueChanged, tile);
+}
+
+static void SubscribeToTile(Controller *controller, Tile *tile) {
+    uint32_t idx = TileGetRow(tile) * GameBoardNumCols(controller->gameBoard) + TileGetColumn(tile);
+    controller->tileSubscriptions[idx].tile = tile;
+    controller->tileSubscriptions[idx].handle = TileAddValueChangeHandler(tile, HandleTileValueChange, controller);
+}
+
+static void UnsubscribeFromTile(Controller *controller, Tile *tile) {
+    uint32_t idx = TileGetRow(tile) * GameBoardNumCols(controller->gameBoard) + TileGetColumn(tile);
+    TileSubscription *subscription = &controller->tileSubscriptions[idx];
+    // The cell may already hold the tile that replaced this one; leave its subscription alone.
+    if (subscription->tile == tile) {
+        TileRemoveValueChangeHandlerByHandle(tile, subscription->handle);
+        memset(subscription, 0, sizeof(TileSubscription));
+    }
+}
+
+static void SubscribeToAllTiles(Controller *controller, int subscribe) {
+    uint32_t rows = GameBoardNumRows(controller->gameBoard);
+    uint32_t cols = GameBoardNumCols(controller->gameBoard);
+    for(int i = 0; i < rows; i++) {
+        for(int j = 0; j < cols; j++) {
+            Tile *t = GameBoardGetTile(controller->gameBoard, i, j);
+            if (t != 0 && subscribe) {
+                SubscribeToTile(controller, t);
+            } else if (t != 0) {
+                UnsubscribeFromTile(controller, t);
+            }
+        }
+    }
+}
+
+static void HandleGameReset(Controller *controller) {
+    if (!controller->usesDiffs) {
+        SubscribeToAllTiles(controller, 1);
+    }
+    NotifyGameReset(controller->gameBoard, controller->updateHandler);
+    PostUpdateEvent(controller, GameEventReset);
+}
+
+static void HandleBoardDiff(GameBoard *gameBoard, const BoardDiff *diff, void *data) {
+    Controller *controller = (Controller *)data;
+    GameUpdateHandler *handler = controller->updateHandler;
+    if (handler != 0 && handler->handleBoardDiff != 0) {
+        handler->handleBoardDiff(handler->target, gameBoard, diff);
+    }
+
+    static const GameEventKind kinds[] = {
+        [BoardChangeMove] = GameEventTileMoved,
+        [BoardChangeMerge] = GameEventTileMerged,
+        [BoardChangeAdd] = GameEventTileAdded,
+        [BoardChangeRemove] = GameEventTileRemoved
+    };
+    for (uint32_t i = 0; controller->eventRing != 0 && i < diff->numChanges; i++) {
+        const BoardChange *change = &diff->changes[i];
+        PostEvent(controller, kinds[change->kind], change->from, change->to, change->exponent);
+    }
+}
+
+static void HandleBoardReset(GameBoard *gameBoard, void *data) {
+    HandleGameReset((Controller *)data);
 }
 
 static void HandleTileAddRemove(Tile *tile, AddRemoveReason reason, void *data) {
     Controller *controller = (Controller *)data;
     GameUpdateHandler *handler = controller->updateHandler;
 
+    if (reason == Reset) {
+        HandleGameReset(controller);
+        return;
+    }
+
     NotifyTileAddRemove(handler, tile, reason);
+    PostTileEvent(controller, reason == Added ? GameEventTileAdded : GameEventTileRemoved, tile);
 
     if (reason == Added) {
-        TileAddValueChangeHandler(tile, HandleTileValueChange, controller);
+        SubscribeToTile(controller, tile);
     } else if (reason == Removed) {
-        TileRemoveValueChangeHandler(tile, HandleTileValueChange);
+        UnsubscribeFromTile(controller, tile);
     }
 }
 
 Controller *ControllerCreate(GameBoard *gameBoard) {
     Controller *controller = calloc(1, sizeof(Controller));
     controller->gameBoard = gameBoard;
+    controller->history = GameHistoryCreate(GameBoardNumRows(gameBoard), GameBoardNumCols(gameBoard));
+    controller->snapshotSize = GameBoardSnapshotSize(gameBoard);
+    controller->currentSnapshot = calloc(1, controller->snapshotSize);
+    controller->restoreSnapshot = calloc(1, controller->snapshotSize);
+    controller->timers = TimerWheelCreate(TIMER_TICK);
+    controller->tileSubscriptions = calloc(GameBoardNumRows(gameBoard) * GameBoardNumCols(gameBoard), sizeof(TileSubscription));
 
-    GameBoardAddTileAddRemoveHandler(gameBoard, controller, HandleTileAddRemove);
+    controller->addRemoveHandle = GameBoardAddTileAddRemoveHandler(gameBoard, controller, HandleTileAddRemove);
 
     return controller;
 }
 
 void ControllerDispose(Controller *controller) {
-    uint32_t rows = GameBoardNumRows(controller->gameBoard);
-    uint32_t cols = GameBoardNumCols(controller->gameBoard);
-    for(int i = 0; i < rows; i++) {
-        for(int j = 0; j < cols; j++) {
-            Tile *t = GameBoardGetTile(controller->gameBoard, i, j);
-            if (t != 0) {
-                TileRemoveValueChangeHandler(t, HandleTileValueChange);
-            }
-        }
+    if (controller->usesDiffs) {
+        GameBoardRemoveDiffHandlerByHandle(controller->gameBoard, controller->diffHandle);
+        GameBoardRemoveResetHandlerByHandle(controller->gameBoard, controller->resetHandle);
+    } else {
+        SubscribeToAllTiles(controller, 0);
+        GameBoardRemoveTileAddRemoveHandlerByHandle(controller->gameBoard, controller->addRemoveHandle);
     }
-    GameBoardRemoveTileAddRemoveHandler(controller->gameBoard, HandleTileAddRemove);
 
+    GameHistoryDispose(controller->history);
+    free(controller->currentSnapshot);
+    free(controller->restoreSnapshot);
+    free(controller->tileSubscriptions);
+    TimerWheelDispose(controller->timers);
+    controller->history = 0;
     controller->gameBoard = 0;
     controller->updateHandler = 0;
     free(controller);
 }
 
+void ControllerStartGame(Controller *controller) {
+    LOG_ASSERT_REASON(controller, ArgumentNullReason);
+    uint32_t rows = GameBoardNumRows(controller->gameBoard);
+    uint32_t cols = GameBoardNumCols(controller->gameBoard);
+    for (uint32_t i = 0; i < rows * cols; i++) {
+        if (GameBoardGetExponent(controller->gameBoard, i / cols, i % cols)) {
+            return;
+        }
+    }
+
+    NotifyBeginUpdate(controller->gameBoard, controller->updateHandler);
+    PostUpdateEvent(controller, GameEventBeginUpdate);
+    GameBoardCell cell;
+    GameBoardTryGetOpenCell(controller->gameBoard, &cell);
+    GameBoardAddTile(controller->gameBoard, cell.row, cell.col);
+    NotifyEndUpdate(controller->gameBoard, controller->updateHandler);
+    PostUpdateEvent(controller, GameEventEndUpdate);
+}
+
 void ControllerSetGameUpdateHandler(Controller *controller, GameUpdateHandler *handler) {
+    int usesDiffs = handler != 0 && handler->handleBoardDiff != 0;
+    // A diff handler takes the board's coalesced changes instead of per-tile notifications, so the
+    // board only does per-tile work for whoever else is still listening.
+    if (usesDiffs && !controller->usesDiffs) {
+        SubscribeToAllTiles(controller, 0);
+        GameBoardRemoveTileAddRemoveHandlerByHandle(controller->gameBoard, controller->addRemoveHandle);
+        controller->diffHandle = GameBoardAddDiffHandler(controller->gameBoard, controller, HandleBoardDiff);
+        controller->resetHandle = GameBoardAddResetHandler(controller->gameBoard, controller, HandleBoardReset);
+    } else if (!usesDiffs && controller->usesDiffs) {
+        GameBoardRemoveDiffHandlerByHandle(controller->gameBoard, controller->diffHandle);
+        GameBoardRemoveResetHandlerByHandle(controller->gameBoard, controller->resetHandle);
+        controller->addRemoveHandle = GameBoardAddTileAddRemoveHandler(controller->gameBoard, controller, HandleTileAddRemove);
+        SubscribeToAllTiles(controller, 1);
+    }
+    controller->usesDiffs = usesDiffs;
     controller->updateHandler = handler;
 }
 
-static void HandleAddNewTile(void *data) {
-    Controller *controller = (Controller *)data;
+TimerWheel *ControllerGetTimers(Controller *controller) {
+    LOG_ASSERT_REASON(controller, ArgumentNullReason);
+    return controller->timers;
+}
+
+void ControllerSetEventRing(Controller *controller, GameEventRing *ring) {
+    LOG_ASSERT_REASON(controller, ArgumentNullReason);
+    controller->eventRing = ring;
+}
+
+static void SpawnPendingTile(Controller *controller) {
+    if (!controller->spawnPending) {
+        return;
+    }
+    controller->spawnPending = 0;
+    TimerWheelCancel(controller->timers, controller->spawnTimer);
+
     GameBoardCell cell;
     int result = GameBoardTryGetOpenCell(controller->gameBoard, &cell);
     LOG_ASSERTMSG(result, "should only ever be here if we can get an open cell");
     GameBoardAddTile(controller->gameBoard, cell.row, cell.col);
 }
 
-void ControllerHandleSlide(Controller *controller, SlideDirection direction) {
-    NotifyBeginUpdate(controller->gameBoard, controller->updateHandler);
+static void HandleAddNewTile(void *data) {
+    SpawnPendingTile((Controller *)data);
+}
+
+static int ApplySlide(Controller *controller, SlideDirection direction) {
+    GameBoardSaveSnapshot(controller->gameBoard, controller->currentSnapshot, controller->snapshotSize);
     int didSlide = GameBoardTrySlide(controller->gameBoard, direction);
+    if (didSlide) {
+        GameHistoryPush(controller->history, controller->currentSnapshot, controller->snapshotSize);
+    }
     GameBoardCell cell;
     int anyOpenCell = GameBoardTryGetOpenCell(controller->gameBoard, &cell);
     if (didSlide && anyOpenCell) {
-        PostDelayedCall(HandleAddNewTile, controller, .2);
+        controller->spawnPending = 1;
     } else if (!didSlide && !anyOpenCell) {
         // TODO: the game might be over! Need a way to check if we can slide in any direction.
     }
+    return didSlide;
+}
+
+int ControllerQueueSlide(Controller *controller, SlideDirection direction) {
+    LOG_ASSERT_REASON(controller, ArgumentNullReason);
+    LOG_ASSERT_REASON(direction <= SlideRight, ArgumentOutOfRangeReason);
+
+    if (controller->inputCount == CONTROLLER_INPUT_CAPACITY) {
+        Log *log = LogGetGlobal();
+        if (log) {
+            LogWrite(log, LogLevelWarning, "input queue full, dropped slide %d", direction);
+        }
+        return 0;
+    }
+    controller->input[(controller->inputStart + controller->inputCount) % CONTROLLER_INPUT_CAPACITY] = direction;
+    controller->inputCount++;
+    return 1;
+}
+
+void ControllerProcessInput(Controller *controller) {
+    LOG_ASSERT_REASON(controller, ArgumentNullReason);
+    if (!controller->inputCount) {
+        return;
+    }
+
+    NotifyBeginUpdate(controller->gameBoard, controller->updateHandler);
+    PostUpdateEvent(controller, GameEventBeginUpdate);
+    int lastDirection = -1, lastSlid = 0;
+    while (controller->inputCount) {
+        SlideDirection direction = controller->input[controller->inputStart];
+        controller->inputStart = (controller->inputStart + 1) % CONTROLLER_INPUT_CAPACITY;
+        controller->inputCount--;
+
+        // A slide that moved nothing spawns nothing, so repeating it can't move anything either.
+        if (controller->collapseInput && (int)direction == lastDirection && !lastSlid) {
+            continue;
+        }
+
+        // The previous move's spawn always lands before the next move, however fast input arrives.
+        SpawnPendingTile(controller);
+        lastSlid = ApplySlide(controller, direction);
+        lastDirection = direction;
+    }
+    NotifyEndUpdate(controller->gameBoard, controller->updateHandler);
+    PostUpdateEvent(controller, GameEventEndUpdate);
+
+    if (controller->spawnPending) {
+        controller->spawnTimer = TimerWheelSchedule(controller->timers, SPAWN_DELAY, HandleAddNewTile, controller);
+    }
+}
+
+void ControllerClearInput(Controller *controller) {
+    LOG_ASSERT_REASON(controller, ArgumentNullReason);
+    controller->inputStart = 0;
+    controller->inputCount = 0;
+}
+
+uint32_t ControllerPendingInput(Controller *controller) {
+    LOG_ASSERT_REASON(controller, ArgumentNullReason);
+    return controller->inputCount;
+}
+
+void ControllerSetCollapseInput(Controller *controller, int collapse) {
+    LOG_ASSERT_REASON(controller, ArgumentNullReason);
+    controller->collapseInput = !!collapse;
+}
+
+void ControllerHandleSlide(Controller *controller, SlideDirection direction) {
+    LOG_ASSERT_REASON(controller, ArgumentNullReason);
+    // Anything already queued goes first so moves are never reordered.
+    if (controller->inputCount == CONTROLLER_INPUT_CAPACITY) {
+        ControllerProcessInput(controller);
+    }
+    ControllerQueueSlide(controller, direction);
+    ControllerProcessInput(controller);
+}
+
+static int RestoreFromHistory(Controller *controller, int isUndo) {
+    // Undo and redo apply to the board the player has seen, so finish anything still queued.
+    ControllerProcessInput(controller);
+    if (isUndo ? !GameHistoryCanUndo(controller->history) : !GameHistoryCanRedo(controller->history)) {
+        return 0;
+    }
+
+    NotifyBeginUpdate(controller->gameBoard, controller->updateHandler);
+    PostUpdateEvent(controller, GameEventBeginUpdate);
+    // A spawn still waiting to land is part of the state we are leaving, so a later redo brings it back.
+    SpawnPendingTile(controller);
+    GameBoardSaveSnapshot(controller->gameBoard, controller->currentSnapshot, controller->snapshotSize);
+    if (isUndo) {
+        GameHistoryUndo(controller->history, controller->currentSnapshot, controller->restoreSnapshot, controller->snapshotSize);
+    } else {
+        GameHistoryRedo(controller->history, controller->currentSnapshot, controller->restoreSnapshot, controller->snapshotSize);
+    }
+    GameBoardRestoreSnapshot(controller->gameBoard, controller->restoreSnapshot, controller->snapshotSize, RestoreNotifyPerTile);
     NotifyEndUpdate(controller->gameBoard, controller->updateHandler);
+    PostUpdateEvent(controller, GameEventEndUpdate);
+    return 1;
+}
+
+int ControllerUndo(Controller *controller) {
+    LOG_ASSERT_REASON(controller, ArgumentNullReason);
+    return RestoreFromHistory(controller, 1);
+}
+
+int ControllerRedo(Controller *controller) {
+    LOG_ASSERT_REASON(controller, ArgumentNullReason);
+    return RestoreFromHistory(controller, 0);
+}
+
+int ControllerCanUndo(Controller *controller) {
+    LOG_ASSERT_REASON(controller, ArgumentNullReason);
+    return GameHistoryCanUndo(controller->history);
+}
+
+int ControllerCanRedo(Controller *controller) {
+    LOG_ASSERT_REASON(controller, ArgumentNullReason);
+    return GameHistoryCanRedo(controller->history);
 }
@@ -7,9 +7,14 @@
 
 #include "cvidef.h"
 #include "gameboard.h"
+#include "event_ring.h"
+#include "timer_wheel.h"
 
 typedef void (*UpdateGameHandler)(void *target, GameBoard *gameBoard);
 typedef void (*TileUpdateHandler)(void *target, Tile *);
+typedef void (*BoardDiffUpdateHandler)(void *target, GameBoard *gameBoard, const BoardDiff *diff);
+
+#define CONTROLLER_INPUT_CAPACITY 32
 
 typedef struct Controller Controller;
 
@@ -20,14 +25,44 @@ typedef struct GameUpdateHandler {
     TileUpdateHandler handleTileAdded;
     TileUpdateHandler handleTileRemoved;
     TileUpdateHandler handleTileValueChange;
+    UpdateGameHandler handleGameReset;
+    // When set, the tile added/removed/value change callbacks are replaced by one diff per change to the board.
+    BoardDiffUpdateHandler handleBoardDiff;
 } GameUpdateHandler;
 
 Controller *ControllerCreate(GameBoard *gameBoard);
 void ControllerDispose(Controller *controller);
+// Places the first tile on an empty board, as its own update. Does nothing once the board has tiles.
+void ControllerStartGame(Controller *controller);
         
 void ControllerSetGameUpdateHandler(Controller *controller, GameUpdateHandler *handler);
+// Optionally mirror every update the handler sees into ring, for readers on other threads. The
+// controller does not own the ring; pass 0 to stop publishing.
+void ControllerSetEventRing(Controller *controller, GameEventRing *ring);
+// Spawns wait on these timers, and a UI can schedule its own work on them too. Nothing fires until
+// the owner advances the wheel or polls it against a clock.
+TimerWheel *ControllerGetTimers(Controller *controller);
+
+// Slides are queued and applied in order. A spawn still waiting from the previous slide always
+// lands before the next slide, so the same input always produces the same game however fast it
+// arrives. ControllerProcessInput applies everything queued inside one begin/end update.
+// Returns 0, and logs a warning, if the queue is full.
+int ControllerQueueSlide(Controller *controller, SlideDirection direction);
+void ControllerProcessInput(Controller *controller);
+void ControllerClearInput(Controller *controller);
+uint32_t ControllerPendingInput(Controller *controller);
+// When set, a queued slide is skipped if the one before it went the same way and moved nothing
+// (key repeat against a wall). A slide that moved anything is always followed by a spawn, so the
+// next slide in the same direction still applies.
+void ControllerSetCollapseInput(Controller *controller, int collapse);
+// Queues the slide and processes the queue straight away.
 void ControllerHandleSlide(Controller *controller, SlideDirection direction);
 
+int ControllerCanUndo(Controller *controller);
+int ControllerCanRedo(Controller *controller);
+int ControllerUndo(Controller *controller);
+int ControllerRedo(Controller *controller);
+
 #ifdef __cplusplus
     }
 #endif
@@ -0,0 +1,113 @@
+#include <windows.h>
+#include <ansi_c.h>
+#include "event_ring.h"
+#include "../../CVI_Core/log.h"
+
+// Written while a slot is being filled; never equal to a position + 1 a reader could expect.
+#define WRITING_FLAG 0x80000000u
+
+typedef struct EventSlot {
+    volatile LONG sequence;
+    GameEvent event;
+} EventSlot;
+
+struct GameEventRing {
+    volatile LONG head;
+    uint32_t capacity;
+    uint32_t mask;
+    EventSlot *slots;
+};
+
+static uint32_t LoadLong(volatile LONG *value) {
+    return (uint32_t)InterlockedCompareExchange(value, 0, 0);
+}
+
+GameEventRing *GameEventRingCreate(uint32_t capacity) {
+    LOG_ASSERT_REASON(capacity && capacity < WRITING_FLAG, ArgumentOutOfRangeReason);
+
+    uint32_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    GameEventRing *ring = calloc(1, sizeof(GameEventRing));
+    ring->capacity = size;
+    ring->mask = size - 1;
+    ring->slots = calloc(size, sizeof(EventSlot));
+    // Slot i first holds position i, so mark every slot as belonging to the lap before that.
+    for (uint32_t i = 0; i < size; i++) {
+        ring->slots[i].sequence = (LONG)(i - size + 1);
+    }
+    return ring;
+}
+
+void GameEventRingDispose(GameEventRing *ring) {
+    LOG_ASSERT_REASON(ring, ArgumentNullReason);
+    free(ring->slots);
+    free(ring);
+}
+
+uint32_t GameEventRingCapacity(GameEventRing *ring) {
+    LOG_ASSERT_REASON(ring, ArgumentNullReason);
+    return ring->capacity;
+}
+
+void GameEventRingPublish(GameEventRing *ring, const GameEvent *event) {
+    LOG_ASSERT_REASON(ring && event, ArgumentNullReason);
+
+    // Only the single writer changes head, so a plain read is its own latest value.
+    uint32_t position = (uint32_t)ring->head;
+    EventSlot *slot = &ring->slots[position & ring->mask];
+    InterlockedExchange(&slot->sequence, (LONG)((position + 1) ^ WRITING_FLAG));
+    slot->event = *event;
+    InterlockedExchange(&slot->sequence, (LONG)(position + 1));
+    InterlockedExchange(&ring->head, (LONG)(position + 1));
+}
+
+GameEventCursor GameEventRingOpenCursor(GameEventRing *ring) {
+    LOG_ASSERT_REASON(ring, ArgumentNullReason);
+    GameEventCursor cursor = { .position = LoadLong(&ring->head) };
+    return cursor;
+}
+
+int GameEventRingRead(GameEventRing *ring, GameEventCursor *cursor, GameEvent *event, uint32_t *missed) {
+    LOG_ASSERT_REASON(ring && cursor && event, ArgumentNullReason);
+
+    uint32_t lost = 0;
+    for (;;) {
+        uint32_t head = LoadLong(&ring->head);
+        if (head == cursor->position) {
+            break;
+        }
+        // The last capacity positions are still in the ring. If the writer is already refilling the
+        // oldest one, the sequence check below catches it and we retry once head has moved.
+        if (head - cursor->position > ring->capacity) {
+            uint32_t oldest = head - ring->capacity;
+            lost += oldest - cursor->position;
+            cursor->position = oldest;
+        }
+
+        EventSlot *slot = &ring->slots[cursor->position & ring->mask];
+        uint32_t expected = cursor->position + 1;
+        if (LoadLong(&slot->sequence) != expected) {
+            continue;
+        }
+        *event = slot->event;
+        MemoryBarrier();
+        // Overwritten while we copied it; it counts as missed on the next pass.
+        if (LoadLong(&slot->sequence) != expected) {
+            continue;
+        }
+
+        cursor->position++;
+        if (missed) {
+            *missed = lost;
+        }
+        return 1;
+    }
+
+    if (missed) {
+        *missed = lost;
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+#ifndef __event_ring_H__
+#define __event_ring_H__
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#include <stdint.h>
+#include "cvidef.h"
+#include "gameboard.h"
+
+typedef enum GameEventKind {
+    GameEventBeginUpdate,
+    GameEventEndUpdate,
+    GameEventReset,
+    GameEventTileAdded,
+    GameEventTileRemoved,
+    GameEventTileValueChanged,
+    GameEventTileMoved,
+    GameEventTileMerged
+} GameEventKind;
+
+// Tiles are described by cell and exponent, never by pointer, since a tile may be gone by the time a
+// reader gets to the event. from is only meaningful for moves and merges; score is the board score
+// at the time of the event.
+typedef struct GameEvent {
+    GameEventKind kind;
+    GameBoardCell from;
+    GameBoardCell to;
+    uint8_t exponent;
+    uint64_t score;
+} GameEvent;
+
+// A fixed-size ring with one writer and any number of readers. The writer never waits: once a
+// reader falls a full ring behind, its oldest events are overwritten and the next read reports how
+// many it missed. Each reader keeps its own cursor.
+typedef struct GameEventRing GameEventRing;
+
+typedef struct GameEventCursor {
+    uint32_t position;
+} GameEventCursor;
+
+// capacity is rounded up to a power of two.
+GameEventRing *GameEventRingCreate(uint32_t capacity);
+void GameEventRingDispose(GameEventRing *ring);
+uint32_t GameEventRingCapacity(GameEventRing *ring);
+
+void GameEventRingPublish(GameEventRing *ring, const GameEvent *event);
+
+// A new cursor only sees events published after it was opened.
+GameEventCursor GameEventRingOpenCursor(GameEventRing *ring);
+// Returns 0 when the reader is caught up. missed (optional) is set to the number of events that
+// were overwritten before this one could be read.
+int GameEventRingRead(GameEventRing *ring, GameEventCursor *cursor, GameEvent *event, uint32_t *missed);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif  /* ndef __event_ring_H__ */
@@ -0,0 +1,324 @@
+#include <ansi_c.h>
+#include <utility.h>
+#include "framebuffer.h"
+#include "board_style.h"
+#include "../../CVI_Core/log.h"
+
+#define GLYPH_WIDTH 5
+#define GLYPH_HEIGHT 7
+// Digits take up about this much of a tile's height, close to the window's fonts.
+#define TEXT_HEIGHT_RATIO .4
+
+// 5x7 digits and '^', one byte per row with the leftmost pixel in bit 4.
+static const uint8_t caretGlyph[GLYPH_HEIGHT] = { 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00 };
+static const uint8_t digitGlyphs[10][GLYPH_HEIGHT] = {
+    { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E },
+    { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E },
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F },
+    { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E },
+    { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 },
+    { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E },
+    { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E },
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },
+    { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E },
+    { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }
+};
+
+struct Framebuffer {
+    GameBoard *gameBoard;
+    Controller *controller;
+    GameUpdateHandler updateHandler;
+    int height;
+    int width;
+    uint8_t *pixels;
+    uint8_t *dirtyCells;
+    int anyDirty;
+    int isUpdating;
+    uint32_t frameCount;
+    double lastRenderTime;
+    double totalRenderTime;
+};
+
+static void FillRect(Framebuffer *fb, BoardStyleRect r, int color) {
+    int top = r.top < 0 ? 0 : r.top;
+    int left = r.left < 0 ? 0 : r.left;
+    int bottom = r.top + r.height > fb->height ? fb->height : r.top + r.height;
+    int right = r.left + r.width > fb->width ? fb->width : r.left + r.width;
+    for (int y = top; y < bottom; y++) {
+        uint8_t *pixel = fb->pixels + ((size_t)y * fb->width + left) * 4;
+        for (int x = left; x < right; x++, pixel += 4) {
+            pixel[0] = (uint8_t)(color >> 16);
+            pixel[1] = (uint8_t)(color >> 8);
+            pixel[2] = (uint8_t)color;
+            pixel[3] = 0xFF;
+        }
+    }
+}
+
+// Rows are filled whole, except near the top and bottom where the corners pull them in.
+static void FillRoundedRect(Framebuffer *fb, BoardStyleRect r, int radius, int color) {
+    for (int dy = 0; dy < r.height; dy++) {
+        int inset = 0;
+        int cornerY = dy < radius ? radius - dy : dy >= r.height - radius ? dy - (r.height - radius - 1) : 0;
+        if (cornerY) {
+            double dx = sqrt((double)radius * radius - (double)(cornerY - .5) * (cornerY - .5));
+            inset = radius - (int)(dx + .5);
+        }
+        BoardStyleRect line = { r.top + dy, r.left + inset, 1, r.width - inset * 2 };
+        FillRect(fb, line, color);
+    }
+}
+
+static void DrawText(Framebuffer *fb, uint8_t exponent, BoardStyleRect tileRect, int color) {
+    const char *text = BoardStyleTileText(exponent);
+    int numDigits = (int)strlen(text);
+    BoardStyleRect textRect = BoardStyleTextRect(tileRect);
+
+    int scale = (int)(tileRect.height * TEXT_HEIGHT_RATIO) / GLYPH_HEIGHT;
+    int widthScale = textRect.width / (numDigits * (GLYPH_WIDTH + 1) - 1);
+    scale = widthScale < scale ? widthScale : scale;
+    scale = scale < 1 ? 1 : scale;
+
+    int textWidth = (numDigits * (GLYPH_WIDTH + 1) - 1) * scale;
+    int top = textRect.top + (textRect.height - GLYPH_HEIGHT * scale) / 2;
+    int left = textRect.left + (textRect.width - textWidth) / 2;
+    for (int i = 0; i < numDigits; i++) {
+        const uint8_t *glyph = text[i] == '^' ? caretGlyph : digitGlyphs[text[i] - '0'];
+        for (int row = 0; row < GLYPH_HEIGHT; row++) {
+            for (int col = 0; col < GLYPH_WIDTH; col++) {
+                if (glyph[row] & (0x10 >> col)) {
+                    BoardStyleRect dot = { top + row * scale, left + col * scale, scale, scale };
+                    FillRect(fb, dot, color);
+                }
+            }
+        }
+        left += (GLYPH_WIDTH + 1) * scale;
+    }
+}
+
+static void DrawCell(Framebuffer *fb, uint32_t row, uint32_t col) {
+    uint32_t numRows = GameBoardNumRows(fb->gameBoard);
+    uint32_t numCols = GameBoardNumCols(fb->gameBoard);
+    BoardStyleRect r = BoardStyleTileRect(numRows, numCols, fb->height, fb->width, row, col);
+    uint8_t exponent = GameBoardGetExponent(fb->gameBoard, row, col);
+
+    FillRect(fb, r, BOARD_STYLE_BACKGROUND);
+    FillRoundedRect(fb, r, BOARD_STYLE_CORNER_RADIUS, BoardStyleTileColor(exponent));
+    if (exponent != 0) {
+        DrawText(fb, exponent, r, BoardStyleTextColor(exponent));
+    }
+}
+
+static void MarkAllDirty(Framebuffer *fb) {
+    memset(fb->dirtyCells, 1, GameBoardNumRows(fb->gameBoard) * GameBoardNumCols(fb->gameBoard));
+    fb->anyDirty = 1;
+}
+
+static void DrawDirtyCells(Framebuffer *fb) {
+    if (!fb->anyDirty) {
+        return;
+    }
+    double start = Timer();
+    uint32_t numCols = GameBoardNumCols(fb->gameBoard);
+    uint32_t numCells = GameBoardNumRows(fb->gameBoard) * numCols;
+    for (uint32_t idx = 0; idx < numCells; idx++) {
+        if (fb->dirtyCells[idx]) {
+            fb->dirtyCells[idx] = 0;
+            DrawCell(fb, idx / numCols, idx % numCols);
+        }
+    }
+    fb->anyDirty = 0;
+
+    fb->lastRenderTime = Timer() - start;
+    fb->totalRenderTime += fb->lastRenderTime;
+    fb->frameCount++;
+}
+
+static void MarkCellDirty(Framebuffer *fb, GameBoardCell cell) {
+    fb->dirtyCells[cell.col + cell.row * GameBoardNumCols(fb->gameBoard)] = 1;
+    fb->anyDirty = 1;
+}
+
+// Changes outside an update are a frame of their own.
+static void DrawIfNotUpdating(Framebuffer *fb) {
+    if (!fb->isUpdating) {
+        DrawDirtyCells(fb);
+    }
+}
+
+static void HandleBeginUpdateGame(void *target, GameBoard *gameBoard) {
+    Framebuffer *fb = (Framebuffer *)target;
+    LOG_ASSERTMSG(!fb->isUpdating, "Updates should not nest");
+    fb->isUpdating = 1;
+}
+
+static void HandleEndUpdateGame(void *target, GameBoard *gameBoard) {
+    Framebuffer *fb = (Framebuffer *)target;
+    fb->isUpdating = 0;
+    DrawDirtyCells(fb);
+}
+
+static void HandleTileChange(void *target, Tile *tile) {
+    Framebuffer *fb = (Framebuffer *)target;
+    MarkCellDirty(fb, GameBoardMakeCell(TileGetRow(tile), TileGetColumn(tile)));
+    DrawIfNotUpdating(fb);
+}
+
+static void HandleBoardDiff(void *target, GameBoard *gameBoard, const BoardDiff *diff) {
+    Framebuffer *fb = (Framebuffer *)target;
+    for (uint32_t i = 0; i < diff->numChanges; i++) {
+        const BoardChange *change = &diff->changes[i];
+        if (change->kind == BoardChangeMove || change->kind == BoardChangeMerge) {
+            MarkCellDirty(fb, change->from);
+        }
+        MarkCellDirty(fb, change->to);
+    }
+    DrawIfNotUpdating(fb);
+}
+
+static void HandleGameReset(void *target, GameBoard *gameBoard) {
+    Framebuffer *fb = (Framebuffer *)target;
+    MarkAllDirty(fb);
+    DrawIfNotUpdating(fb);
+}
+
+static void RunFramebuffer(UserInterface *ui) {
+    LOG_ASSERT_REASON(ui, ArgumentNullReason);
+    FramebufferRender((Framebuffer *)ui->data);
+}
+
+static void DisposeFramebuffer(UserInterface *ui) {
+    LOG_ASSERT_REASON(ui, ArgumentNullReason);
+    FramebufferDispose((Framebuffer *)ui->data);
+    free(ui);
+}
+
+Framebuffer *FramebufferCreate(GameBoard *gameBoard, Controller *controller, int height, int width) {
+    LOG_ASSERT_REASON(gameBoard, ArgumentNullReason);
+
+    Framebuffer *fb = calloc(1, sizeof(Framebuffer));
+    fb->gameBoard = gameBoard;
+    fb->controller = controller;
+    fb->dirtyCells = calloc(GameBoardNumRows(gameBoard) * GameBoardNumCols(gameBoard), sizeof(uint8_t));
+    FramebufferResize(fb, height, width);
+    if (controller) {
+        fb->updateHandler.target = fb;
+        fb->updateHandler.beginUpdateGame = HandleBeginUpdateGame;
+        fb->updateHandler.endUpdateGame = HandleEndUpdateGame;
+        fb->updateHandler.handleTileAdded = HandleTileChange;
+        fb->updateHandler.handleTileRemoved = HandleTileChange;
+        fb->updateHandler.handleTileValueChange = HandleTileChange;
+        fb->updateHandler.handleGameReset = HandleGameReset;
+        fb->updateHandler.handleBoardDiff = HandleBoardDiff;
+        ControllerSetGameUpdateHandler(controller, &fb->updateHandler);
+    }
+    return fb;
+}
+
+void FramebufferDispose(Framebuffer *framebuffer) {
+    LOG_ASSERT_REASON(framebuffer, ArgumentNullReason);
+    if (framebuffer->controller) {
+        ControllerSetGameUpdateHandler(framebuffer->controller, 0);
+    }
+    free(framebuffer->pixels);
+    free(framebuffer->dirtyCells);
+    free(framebuffer);
+}
+
+UserInterface *FramebufferCreateUserInterface(Game2048 *game) {
+    LOG_ASSERT_REASON(game, ArgumentNullReason);
+
+    UserInterface *ui = calloc(1, sizeof(UserInterface));
+    ui->data = FramebufferCreate(Game2048GameBoard(game), Game2048Controller(game), FRAMEBUFFER_DEFAULT_SIZE, FRAMEBUFFER_DEFAULT_SIZE);
+    ui->run = RunFramebuffer;
+    ui->dispose = DisposeFramebuffer;
+    return ui;
+}
+
+Framebuffer *FramebufferFromUserInterface(UserInterface *ui) {
+    LOG_ASSERT_REASON(ui, ArgumentNullReason);
+    LOG_ASSERTMSG_REASON(ui->run == RunFramebuffer, "not a framebuffer user interface", ArgumentOutOfRangeReason);
+    return (Framebuffer *)ui->data;
+}
+
+void FramebufferResize(Framebuffer *framebuffer, int height, int width) {
+    LOG_ASSERT_REASON(framebuffer, ArgumentNullReason);
+    LOG_ASSERT_REASON(height > 0 && width > 0, ArgumentOutOfRangeReason);
+
+    free(framebuffer->pixels);
+    framebuffer->pixels = malloc((size_t)height * width * 4);
+    framebuffer->height = height;
+    framebuffer->width = width;
+    BoardStyleRect all = { 0, 0, height, width };
+    FillRect(framebuffer, all, BOARD_STYLE_BACKGROUND);
+    MarkAllDirty(framebuffer);
+}
+
+void FramebufferRender(Framebuffer *framebuffer) {
+    LOG_ASSERT_REASON(framebuffer, ArgumentNullReason);
+    MarkAllDirty(framebuffer);
+    DrawDirtyCells(framebuffer);
+}
+
+const uint8_t *FramebufferPixels(Framebuffer *framebuffer, int *height, int *width) {
+    LOG_ASSERT_REASON(framebuffer, ArgumentNullReason);
+    if (height) {
+        *height = framebuffer->height;
+    }
+    if (width) {
+        *width = framebuffer->width;
+    }
+    return framebuffer->pixels;
+}
+
+int FramebufferGetPixel(Framebuffer *framebuffer, int y, int x) {
+    LOG_ASSERT_REASON(framebuffer, ArgumentNullReason);
+    LOG_ASSERT_REASON(y >= 0 && y < framebuffer->height && x >= 0 && x < framebuffer->width, ArgumentOutOfRangeReason);
+    const uint8_t *pixel = framebuffer->pixels + ((size_t)y * framebuffer->width + x) * 4;
+    return (pixel[0] << 16) | (pixel[1] << 8) | pixel[2];
+}
+
+uint32_t FramebufferFrameCount(Framebuffer *framebuffer) {
+    LOG_ASSERT_REASON(framebuffer, ArgumentNullReason);
+    return framebuffer->frameCount;
+}
+
+double FramebufferLastRenderTime(Framebuffer *framebuffer) {
+    LOG_ASSERT_REASON(framebuffer, ArgumentNullReason);
+    return framebuffer->lastRenderTime;
+}
+
+double FramebufferTotalRenderTime(Framebuffer *framebuffer) {
+    LOG_ASSERT_REASON(framebuffer, ArgumentNullReason);
+    return framebuffer->totalRenderTime;
+}
+
+int FramebufferWritePpm(Framebuffer *framebuffer, FILE *file) {
+    LOG_ASSERT_REASON(framebuffer && file, ArgumentNullReason);
+
+    if (fprintf(file, "P6\n%d %d\n255\n", framebuffer->width, framebuffer->height) < 0) {
+        return 0;
+    }
+    uint8_t *row = malloc((size_t)framebuffer->width * 3);
+    int ok = 1;
+    for (int y = 0; ok && y < framebuffer->height; y++) {
+        const uint8_t *pixel = framebuffer->pixels + (size_t)y * framebuffer->width * 4;
+        for (int x = 0; x < framebuffer->width; x++, pixel += 4) {
+            memcpy(row + x * 3, pixel, 3);
+        }
+        ok = fwrite(row, 3, framebuffer->width, file) == (size_t)framebuffer->width;
+    }
+    free(row);
+    return ok;
+}
+
+int FramebufferSavePpm(Framebuffer *framebuffer, const char *path) {
+    LOG_ASSERT_REASON(framebuffer && path, ArgumentNullReason);
+
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return 0;
+    }
+    int ok = FramebufferWritePpm(framebuffer, file);
+    return fclose(file) == 0 && ok;
+}
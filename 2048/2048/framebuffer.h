@@ -0,0 +1,49 @@
+#ifndef __framebuffer_H__
+#define __framebuffer_H__
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include "cvidef.h"
+#include "game.h"
+
+#define FRAMEBUFFER_DEFAULT_SIZE 500
+
+// A UserInterface that draws the board into an RGBA buffer in memory, with the same layout and
+// colours as the window. Nothing is shown and run only renders the current board, so it works
+// anywhere the engine does: profiling, image regression tests, thumbnails of saved games.
+typedef struct Framebuffer Framebuffer;
+
+// Draws gameBoard, following the controller's updates when one is given.
+Framebuffer *FramebufferCreate(GameBoard *gameBoard, Controller *controller, int height, int width);
+void FramebufferDispose(Framebuffer *framebuffer);
+
+UserInterface *FramebufferCreateUserInterface(Game2048 *game);
+Framebuffer *FramebufferFromUserInterface(UserInterface *ui);
+
+void FramebufferResize(Framebuffer *framebuffer, int height, int width);
+// Redraws the whole board. Updates from the controller only redraw the cells they touch.
+void FramebufferRender(Framebuffer *framebuffer);
+
+// Four bytes per pixel (red, green, blue, alpha), row by row from the top left.
+const uint8_t *FramebufferPixels(Framebuffer *framebuffer, int *height, int *width);
+// The pixel as 0xRRGGBB.
+int FramebufferGetPixel(Framebuffer *framebuffer, int y, int x);
+
+// A frame is one update from the controller or one call to FramebufferRender.
+uint32_t FramebufferFrameCount(Framebuffer *framebuffer);
+double FramebufferLastRenderTime(Framebuffer *framebuffer);
+double FramebufferTotalRenderTime(Framebuffer *framebuffer);
+
+// Binary PPM (P6); alpha is dropped. Both return 0 on a write error.
+int FramebufferWritePpm(Framebuffer *framebuffer, FILE *file);
+int FramebufferSavePpm(Framebuffer *framebuffer, const char *path);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif  /* ndef __framebuffer_H__ */
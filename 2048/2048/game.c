@@ -6,6 +6,7 @@ struct Game2048{
     uint32_t numRows;
     uint32_t numCols;
     CreateUserInterfaceHandler createUI;
+    int headless;
     UserInterface *ui;
     GameBoard *gameBoard;
     Controller *controller;
@@ -14,6 +15,7 @@ struct Game2048{
 static GameBoard *GetOrCreateGameBoard(Game2048 *game) {
     if (!game->gameBoard) {
         game->gameBoard = GameBoardCreate(game->numRows, game->numCols);
+        GameBoardSetHeadless(game->gameBoard, game->headless);
     }
     return game->gameBoard;
 }
@@ -27,6 +29,7 @@ static Controller *GetOrCreateController(Game2048 *game) {
 
 static UserInterface *GetOrCreateUserInterface(Game2048 *game) {
     if (!game->ui) {
+        LOG_ASSERTMSG_REASON(game->createUI, "game has no user interface", InvalidOperationReason);
         game->ui = game->createUI(game);
     }
     return game->ui;
@@ -40,16 +43,24 @@ Game2048 *Game2048Create(uint32_t numRows, uint32_t numCols, CreateUserInterface
     return game;
 }
 
+Game2048 *Game2048CreateHeadless(uint32_t numRows, uint32_t numCols) {
+    Game2048 *game = Game2048Create(numRows, numCols, 0);
+    game->headless = 1;
+    return game;
+}
+
 void Game2048Dispose(Game2048 *game) {
+    // The UI holds timers on the controller's wheel and listens to the board, so it goes first.
+    if (game->ui != 0) {
+        game->ui->dispose(game->ui);
+    }
     if (game->controller != 0) {
         ControllerDispose(game->controller);
     }
     if (game->gameBoard != 0) {
         GameBoardDispose(game->gameBoard);
     }
-    if (game->ui != 0) {
-        game->ui->dispose(game->ui);
-    }
+    game->ui = 0;
     game->gameBoard = 0;
     game->controller = 0;
     free(game);
@@ -59,6 +70,8 @@ void Game2048Dispose(Game2048 *game) {
 
 void Game2048Run(Game2048 *game) {
     UserInterface *ui = GetOrCreateUserInterface(game);
+    // Every user interface starts from the same first tile, placed once it is listening.
+    ControllerStartGame(GetOrCreateController(game));
     ui->run(ui);
 }
 
@@ -73,3 +86,16 @@ Controller *Game2048Controller(Game2048 *game) {
 UserInterface *Game2048UserInterface(Game2048 *game) {
     return GetOrCreateUserInterface(game);
 }
+
+void Game2048SetHeadless(Game2048 *game, int headless) {
+    LOG_ASSERT_REASON(game, ArgumentNullReason);
+    game->headless = !!headless;
+    if (game->gameBoard != 0) {
+        GameBoardSetHeadless(game->gameBoard, game->headless);
+    }
+}
+
+int Game2048IsHeadless(Game2048 *game) {
+    LOG_ASSERT_REASON(game, ArgumentNullReason);
+    return game->headless;
+}
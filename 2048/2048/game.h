@@ -21,6 +21,7 @@ typedef struct UserInterface {
 typedef UserInterface *(*CreateUserInterfaceHandler)(Game2048 *);
 
 Game2048 *Game2048Create(uint32_t numRows, uint32_t numCols, CreateUserInterfaceHandler createUI);
+Game2048 *Game2048CreateHeadless(uint32_t numRows, uint32_t numCols);
 void Game2048Dispose(Game2048 *game);
 
 GameBoard *Game2048GameBoard(Game2048 *game);
@@ -29,6 +30,9 @@ UserInterface *Game2048UserInterface(Game2048 *game);
 
 void Game2048Run(Game2048 *game);
 
+void Game2048SetHeadless(Game2048 *game, int headless);
+int Game2048IsHeadless(Game2048 *game);
+
 #ifdef __cplusplus
     }
 #endif
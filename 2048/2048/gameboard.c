@@ -1,19 +1,31 @@
 #include <ansi_c.h>
-#include <toolbox.h>
 #include "gameboard.h"
 #include "tile.h"
-#include "change_notification.h"
+#include "shared_listeners.h"
 #include "NextCellGenerator.h"
 #include "../../CVI_Core/log.h"
 
-static Tile *changeTile;
-
 struct GameBoard {
     uint32_t numRows;
     uint32_t numCols;
-    Tile **tiles;
+    uint32_t rngState;
+    uint64_t score;
+    int headless;
+    // One exponent per cell, 0 when empty. This is the board; tiles are handles made on demand.
+    uint8_t *cells;
+    Tile **handles;
+    // Optional transposed copy of cells for vertical slides, with Up/Down pairs in its index space.
+    uint8_t *columns;
+    CellIndexPair *columnPairs[2];
     NextCellGenerator *slideHandlers[4];
-    ListenerList addRemoveListeners;
+    SharedListenerList *addRemoveListeners;
+    SharedListenerList *diffListeners;
+    SharedListenerList *resetListeners;
+    uint32_t *origins;
+    uint32_t *finalIndices;
+    uint8_t *merged;
+    BoardChange *changes;
+    BoardDiff diff;
 };
 
 typedef struct ClientAddRemoveTileData {
@@ -21,6 +33,21 @@ typedef struct ClientAddRemoveTileData {
     AddRemoveTileHandler handler;
 } ClientAddRemoveTileData;
 
+typedef struct AddRemoveTileArgs {
+    Tile *tile;
+    AddRemoveReason reason;
+} AddRemoveTileArgs;
+
+typedef struct ClientDiffData {
+    void *data;
+    BoardDiffHandler handler;
+} ClientDiffData;
+
+typedef struct ClientResetData {
+    void *data;
+    BoardResetHandler handler;
+} ClientResetData;
+
 static uint32_t MakeBoardIndex(GameBoard *gameBoard, uint32_t row, uint32_t col) {
     LOG_ASSERT_REASON(gameBoard, ArgumentNullReason);
     LOG_ASSERT_REASON(row < gameBoard->numRows, ArgumentOutOfRangeReason);
@@ -30,36 +57,140 @@ static uint32_t MakeBoardIndex(GameBoard *gameBoard, uint32_t row, uint32_t col)
     return idx;
 }
 
-static void SetTile(GameBoard *gameBoard, uint32_t row, uint32_t col, Tile *tile) {
-    uint32_t idx = MakeBoardIndex(gameBoard, row, col);
-    gameBoard->tiles[idx] = tile;
+#define TRANSPOSE_BLOCK 16
+
+// Copies a rows x cols row-major array into dst as cols x rows, a block at a time so neither side
+// strides across more cache lines than a block touches.
+static void Transpose(const uint8_t *src, uint8_t *dst, uint32_t rows, uint32_t cols) {
+    for (uint32_t r0 = 0; r0 < rows; r0 += TRANSPOSE_BLOCK) {
+        uint32_t rEnd = r0 + TRANSPOSE_BLOCK < rows ? r0 + TRANSPOSE_BLOCK : rows;
+        for (uint32_t c0 = 0; c0 < cols; c0 += TRANSPOSE_BLOCK) {
+            uint32_t cEnd = c0 + TRANSPOSE_BLOCK < cols ? c0 + TRANSPOSE_BLOCK : cols;
+            for (uint32_t r = r0; r < rEnd; r++) {
+                for (uint32_t c = c0; c < cEnd; c++) {
+                    dst[c * rows + r] = src[r * cols + c];
+                }
+            }
+        }
+    }
 }
 
-static void OnAddRemoveTile(void *target, void *data) {
-    GameBoard *gb = (GameBoard *)target;
-    ClientAddRemoveTileData *d = (ClientAddRemoveTileData *)data;
-    AddRemoveTileHandler handler = d->handler;
+static uint32_t NextRandom(GameBoard *gameBoard) {
+    // xorshift32 - each board owns its own stream so snapshots can capture and restore it.
+    uint32_t x = gameBoard->rngState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    gameBoard->rngState = x;
+    return x;
+}
+
+// A merge into 2^64 or beyond would take longer than any game; the score just stops there.
+static uint64_t ExponentToScore(uint8_t exponent) {
+    return exponent < 64 ? (uint64_t)1 << exponent : UINT64_MAX;
+}
+
+static int IsCoalescing(GameBoard *gameBoard) {
+    return !gameBoard->headless && SharedListenersCount(gameBoard->diffListeners) != 0;
+}
+
+static int SendsPerTileNotifications(GameBoard *gameBoard) {
+    return !gameBoard->headless && SharedListenersCount(gameBoard->addRemoveListeners) != 0;
+}
+
+static GameBoardCell IndexToCell(GameBoard *gameBoard, uint32_t idx) {
+    return GameBoardMakeCell(idx / gameBoard->numCols, idx % gameBoard->numCols);
+}
+
+static void BeginDiff(GameBoard *gameBoard) {
+    gameBoard->diff.numChanges = 0;
+    gameBoard->diff.scoreDelta = 0;
+}
+
+static void RecordChange(GameBoard *gameBoard, BoardChangeKind kind, uint32_t fromIdx, uint32_t toIdx) {
+    BoardChange change = {
+        .kind = kind,
+        .from = IndexToCell(gameBoard, fromIdx),
+        .to = IndexToCell(gameBoard, toIdx),
+        .exponent = gameBoard->cells[toIdx]
+    };
+    gameBoard->changes[gameBoard->diff.numChanges++] = change;
+}
 
-    LOG_ASSERT_REASON(changeTile, InvalidOperationReason);
-    uint32_t row = TileGetRow(changeTile);
-    uint32_t col = TileGetColumn(changeTile);
-    LOG_ASSERT_REASON(row < gb->numRows, InvalidOperationReason);
-    LOG_ASSERT_REASON(col < gb->numCols, InvalidOperationReason);
-    uint32_t idx = MakeBoardIndex(gb, row, col);
-    int removed = !gb->tiles[idx];
-    AddRemoveReason reason = removed ? Removed : Added;
+static void EmitDiff(GameBoard *gameBoard) {
+    if (gameBoard->diff.numChanges) {
+        gameBoard->diff.changes = gameBoard->changes;
+        SharedListenersNotify(gameBoard->diffListeners, &gameBoard->diff);
+    }
+}
+
+static void OnDiff(void *target, void *data, void *args) {
+    ClientDiffData *d = (ClientDiffData *)data;
+    d->handler((GameBoard *)target, (const BoardDiff *)args, d->data);
+}
+
+static void NotifyAddRemove(GameBoard *gameBoard, Tile *tile, AddRemoveReason reason) {
+    AddRemoveTileArgs args = { .tile = tile, .reason = reason };
+    SharedListenersNotify(gameBoard->addRemoveListeners, &args);
+}
+
+static void OnReset(void *target, void *data, void *args) {
+    ClientResetData *d = (ClientResetData *)data;
+    d->handler((GameBoard *)target, d->data);
+}
+
+static void NotifyReset(GameBoard *gameBoard) {
+    NotifyAddRemove(gameBoard, 0, Reset);
+    SharedListenersNotify(gameBoard->resetListeners, 0);
+}
+
+static Tile *GetHandle(GameBoard *gameBoard, uint32_t idx) {
+    if (!gameBoard->handles) {
+        gameBoard->handles = calloc(gameBoard->numRows * gameBoard->numCols, sizeof(Tile*));
+    }
+    if (!gameBoard->handles[idx]) {
+        GameBoardCell cell = IndexToCell(gameBoard, idx);
+        gameBoard->handles[idx] = TileCreateHandle(cell.row, cell.col, &gameBoard->cells[idx]);
+    }
+    return gameBoard->handles[idx];
+}
+
+static void ClearTileHandlers(GameBoard *gameBoard, uint32_t idx) {
+    if (gameBoard->handles && gameBoard->handles[idx]) {
+        TileClearValueChangeHandlers(gameBoard->handles[idx]);
+    }
+}
+
+static void ClearAllTileHandlers(GameBoard *gameBoard) {
+    for (uint32_t i = 0; i < gameBoard->numRows * gameBoard->numCols; i++) {
+        ClearTileHandlers(gameBoard, i);
+    }
+}
+
+static void OnAddRemoveTile(void *target, void *data, void *args) {
+    ClientAddRemoveTileData *d = (ClientAddRemoveTileData *)data;
+    AddRemoveTileArgs *a = (AddRemoveTileArgs *)args;
+    LOG_ASSERT_REASON(a, InvalidOperationReason);
 
-    handler(changeTile, reason, d->data);
+    d->handler(a->tile, a->reason, d->data);
 }
 
 GameBoard *GameBoardCreate(uint32_t numRows, uint32_t numCols) {
     LOG_ASSERT_REASON(numRows && numCols, ArgumentOutOfRangeReason);
 
-    srand(time(0));
     GameBoard *gb = calloc(1, sizeof(*gb));
-    gb->tiles = calloc(numRows * numCols, sizeof(Tile*));
+    gb->cells = calloc(numRows * numCols, sizeof(uint8_t));
+    gb->addRemoveListeners = SharedListenersCreate();
+    gb->diffListeners = SharedListenersCreate();
+    gb->resetListeners = SharedListenersCreate();
     gb->numRows = numRows;
     gb->numCols = numCols;
+    gb->origins = calloc(numRows * numCols, sizeof(uint32_t));
+    gb->finalIndices = calloc(numRows * numCols, sizeof(uint32_t));
+    gb->merged = calloc(numRows * numCols, sizeof(uint8_t));
+    // Enough for a per-tile restore: every cell removed and re-added.
+    gb->changes = calloc(numRows * numCols * 2, sizeof(BoardChange));
+    GameBoardSetSeed(gb, (uint32_t)time(0) ^ (uint32_t)(uintptr_t)gb);
     gb->slideHandlers[SlideUp] = CellGeneratorCreate(gb, SlideUp);
     gb->slideHandlers[SlideDown] = CellGeneratorCreate(gb, SlideDown);
     gb->slideHandlers[SlideLeft] = CellGeneratorCreate(gb, SlideLeft);
@@ -68,7 +199,7 @@ GameBoard *GameBoardCreate(uint32_t numRows, uint32_t numCols) {
 }
 
 void GameBoardDispose(GameBoard *gameBoard) {
-    LOG_ASSERT_REASON(gameBoard && gameBoard->tiles, ArgumentNullReason);
+    LOG_ASSERT_REASON(gameBoard && gameBoard->cells, ArgumentNullReason);
 
     CellGeneratorDispose(gameBoard->slideHandlers[SlideUp]);
     CellGeneratorDispose(gameBoard->slideHandlers[SlideDown]);
@@ -79,17 +210,23 @@ void GameBoardDispose(GameBoard *gameBoard) {
     gameBoard->slideHandlers[SlideLeft] = 0;
     gameBoard->slideHandlers[SlideRight] = 0;
 
-    for (int i = 0; i < gameBoard->numRows; i++) {
-        for (int j = 0; j < gameBoard->numCols; j++) {
-            Tile *t = GameBoardGetTile(gameBoard, i, j);
-            if (t != 0) {
-                TileDispose(t);
-            }
+    for (uint32_t i = 0; gameBoard->handles && i < gameBoard->numRows * gameBoard->numCols; i++) {
+        if (gameBoard->handles[i]) {
+            TileDispose(gameBoard->handles[i]);
         }
     }
 
-    free(gameBoard->tiles);
-    gameBoard->tiles = 0;
+    SharedListenersDispose(gameBoard->addRemoveListeners, free);
+    SharedListenersDispose(gameBoard->diffListeners, free);
+    SharedListenersDispose(gameBoard->resetListeners, free);
+    free(gameBoard->origins);
+    free(gameBoard->finalIndices);
+    free(gameBoard->merged);
+    free(gameBoard->changes);
+    GameBoardSetColumnMirror(gameBoard, 0);
+    free(gameBoard->handles);
+    free(gameBoard->cells);
+    gameBoard->cells = 0;
     free(gameBoard);
 }
 
@@ -103,7 +240,13 @@ uint32_t GameBoardNumCols(GameBoard  *gameBoard) {
     return gameBoard->numCols;
 }
 
-void GameBoardAddTileAddRemoveHandler(GameBoard *gameBoard, void *data, AddRemoveTileHandler handler) {
+void GameBoardSetSeed(GameBoard *gameBoard, uint32_t seed) {
+    LOG_ASSERT_REASON(gameBoard, ArgumentNullReason);
+    // xorshift never leaves the zero state, so nudge it.
+    gameBoard->rngState = seed ? seed : 0x2048;
+}
+
+ListenerHandle GameBoardAddTileAddRemoveHandler(GameBoard *gameBoard, void *data, AddRemoveTileHandler handler) {
     LOG_ASSERT_REASON(gameBoard && handler, ArgumentNullReason);
 
     ClientAddRemoveTileData *d = calloc(1, sizeof(ClientAddRemoveTileData));
@@ -111,21 +254,122 @@ void GameBoardAddTileAddRemoveHandler(GameBoard *gameBoard, void *data, AddRemov
     d->handler = handler;
 
     ChangeData changeData = { .target = gameBoard, .data = d, .handler = OnAddRemoveTile };
-    ChangeHandlerAdd(&gameBoard->addRemoveListeners, changeData);
+    return SharedListenersAdd(gameBoard->addRemoveListeners, changeData);
 }
 
 void GameBoardRemoveTileAddRemoveHandler(GameBoard *gameBoard, AddRemoveTileHandler handler) {
     LOG_ASSERT_REASON(gameBoard && handler, ArgumentNullReason);
 
-    ClientAddRemoveTileData *data;
     ChangeData changeData = { .target = gameBoard, .data = 0, .handler = OnAddRemoveTile };
-    data = (ClientAddRemoveTileData *)ChangeHandlerRemove(&gameBoard->addRemoveListeners, changeData);
-    free(data);
+    SharedListenersRemove(gameBoard->addRemoveListeners, changeData, free);
+}
+
+void GameBoardRemoveTileAddRemoveHandlerByHandle(GameBoard *gameBoard, ListenerHandle handle) {
+    LOG_ASSERT_REASON(gameBoard, ArgumentNullReason);
+    SharedListenersRemoveHandle(gameBoard->addRemoveListeners, handle, free);
+}
+
+void GameBoardSetHeadless(GameBoard *gameBoard, int headless) {
+    LOG_ASSERT_REASON(gameBoard, ArgumentNullReason);
+    int wasHeadless = gameBoard->headless;
+    gameBoard->headless = !!headless;
+    if (wasHeadless && !headless) {
+        // Same contract as a reset restore: tile subscriptions are dropped and listeners resubscribe.
+        ClearAllTileHandlers(gameBoard);
+        NotifyReset(gameBoard);
+    }
+}
+
+int GameBoardIsHeadless(GameBoard *gameBoard) {
+    LOG_ASSERT_REASON(gameBoard, ArgumentNullReason);
+    return gameBoard->headless;
+}
+
+void GameBoardSetColumnMirror(GameBoard *gameBoard, int enabled) {
+    LOG_ASSERT_REASON(gameBoard, ArgumentNullReason);
+    if (!enabled) {
+        free(gameBoard->columns);
+        free(gameBoard->columnPairs[SlideUp]);
+        free(gameBoard->columnPairs[SlideDown]);
+        gameBoard->columns = 0;
+        gameBoard->columnPairs[SlideUp] = 0;
+        gameBoard->columnPairs[SlideDown] = 0;
+        return;
+    }
+    if (gameBoard->columns) {
+        return;
+    }
+
+    uint32_t rows = gameBoard->numRows;
+    uint32_t cols = gameBoard->numCols;
+    gameBoard->columns = calloc(rows * cols, sizeof(uint8_t));
+    gameBoard->columnPairs[SlideUp] = calloc(rows * cols, sizeof(CellIndexPair));
+    gameBoard->columnPairs[SlideDown] = calloc(rows * cols, sizeof(CellIndexPair));
+    // Same order within each column as the row-major tables; columns never interact on a vertical
+    // slide, so finishing one column before the next gives the same board.
+    uint32_t n = 0;
+    for (uint32_t col = 0; col < cols; col++) {
+        for (uint32_t row = 1; row < rows; row++, n++) {
+            uint32_t up = col * rows + row;
+            uint32_t down = col * rows + rows - 1 - row;
+            gameBoard->columnPairs[SlideUp][n] = (CellIndexPair){ .source = up, .target = up - 1 };
+            gameBoard->columnPairs[SlideDown][n] = (CellIndexPair){ .source = down, .target = down + 1 };
+        }
+    }
+}
+
+int GameBoardUsesColumnMirror(GameBoard *gameBoard) {
+    LOG_ASSERT_REASON(gameBoard, ArgumentNullReason);
+    return gameBoard->columns != 0;
+}
+
+ListenerHandle GameBoardAddDiffHandler(GameBoard *gameBoard, void *data, BoardDiffHandler handler) {
+    LOG_ASSERT_REASON(gameBoard && handler, ArgumentNullReason);
+
+    ClientDiffData *d = calloc(1, sizeof(ClientDiffData));
+    d->data = data;
+    d->handler = handler;
+
+    ChangeData changeData = { .target = gameBoard, .data = d, .handler = OnDiff };
+    return SharedListenersAdd(gameBoard->diffListeners, changeData);
+}
+
+void GameBoardRemoveDiffHandler(GameBoard *gameBoard, BoardDiffHandler handler) {
+    LOG_ASSERT_REASON(gameBoard && handler, ArgumentNullReason);
+
+    ChangeData changeData = { .target = gameBoard, .data = 0, .handler = OnDiff };
+    SharedListenersRemove(gameBoard->diffListeners, changeData, free);
+}
+
+void GameBoardRemoveDiffHandlerByHandle(GameBoard *gameBoard, ListenerHandle handle) {
+    LOG_ASSERT_REASON(gameBoard, ArgumentNullReason);
+    SharedListenersRemoveHandle(gameBoard->diffListeners, handle, free);
+}
+
+ListenerHandle GameBoardAddResetHandler(GameBoard *gameBoard, void *data, BoardResetHandler handler) {
+    LOG_ASSERT_REASON(gameBoard && handler, ArgumentNullReason);
+
+    ClientResetData *d = calloc(1, sizeof(ClientResetData));
+    d->data = data;
+    d->handler = handler;
+
+    ChangeData changeData = { .target = gameBoard, .data = d, .handler = OnReset };
+    return SharedListenersAdd(gameBoard->resetListeners, changeData);
+}
+
+void GameBoardRemoveResetHandlerByHandle(GameBoard *gameBoard, ListenerHandle handle) {
+    LOG_ASSERT_REASON(gameBoard, ArgumentNullReason);
+    SharedListenersRemoveHandle(gameBoard->resetListeners, handle, free);
 }
 
 Tile *GameBoardGetTile(GameBoard *gameBoard, uint32_t row, uint32_t column) {
     uint32_t idx = MakeBoardIndex(gameBoard, row, column);
-    return gameBoard->tiles[idx];
+    return gameBoard->cells[idx] ? GetHandle(gameBoard, idx) : 0;
+}
+
+uint8_t GameBoardGetExponent(GameBoard *gameBoard, uint32_t row, uint32_t column) {
+    uint32_t idx = MakeBoardIndex(gameBoard, row, column);
+    return gameBoard->cells[idx];
 }
 
 GameBoardCell GameBoardMakeCell(int row, int col) {
@@ -149,92 +393,376 @@ int GameBoardTryGetOpenCell(GameBoard *gameBoard, GameBoardCell *cell) {
     memset(cells, 0, sizeof(GameBoardCell) * rows * cols);
     for (int i = 0; i < rows; i++) {
         for (int j = 0; j < cols; j++) {
-            if (!GameBoardGetTile(gameBoard, i, j)) {
+            if (!gameBoard->cells[j + i * cols]) {
                 cells[openTiles] = GameBoardMakeCell(i, j);
                 openTiles++;
             }
         }
     }
 
-    *cell = openTiles ? cells[rand() % openTiles] : GameBoardMakeCell(-1, -1);
+    *cell = openTiles ? cells[NextRandom(gameBoard) % openTiles] : GameBoardMakeCell(-1, -1);
     return GameBoardIsValidCell(gameBoard, *cell);
 }
 
 int GameBoardCanAddTile(GameBoard *gameBoard, uint32_t row, uint32_t col) {
     uint32_t idx = MakeBoardIndex(gameBoard, row, col);
-    int noTileAtCell = !gameBoard->tiles[idx];
+    int noTileAtCell = !gameBoard->cells[idx];
     return noTileAtCell;
 }
 
-static void RemoveTile(GameBoard *gameBoard, Tile *tile) {
-    uint32_t row = TileGetRow(tile);
-    uint32_t col = TileGetColumn(tile);
-    uint32_t idx = MakeBoardIndex(gameBoard, row, col);
-    gameBoard->tiles[idx] = 0;
+// perTile is latched by the caller once per operation, so a listener added mid-slide from another
+// thread can't see half of it.
+static void RemoveTile(GameBoard *gameBoard, uint32_t idx, int perTile) {
+    if (perTile) {
+        // Listeners still read the old value through the handle; it is emptied once they are done.
+        NotifyAddRemove(gameBoard, GetHandle(gameBoard, idx), Removed);
+    }
+    gameBoard->cells[idx] = 0;
+    ClearTileHandlers(gameBoard, idx);
+}
+
+static void AddTileCore(GameBoard *gameBoard, uint32_t idx, uint8_t exponent, int perTile) {
+    gameBoard->cells[idx] = exponent;
 
-    changeTile = tile;
-    ChangeHandlerNotifyListeners(gameBoard->addRemoveListeners);
-    changeTile = 0;
-    TileDispose(tile);
+    if (perTile) {
+        NotifyAddRemove(gameBoard, GetHandle(gameBoard, idx), Added);
+    }
 }
 
-static void AddTileCore(GameBoard *gameBoard, Tile *tile) {
-    uint32_t row = TileGetRow(tile);
-    uint32_t col = TileGetColumn(tile);
-    uint32_t idx = MakeBoardIndex(gameBoard, row, col);
-    gameBoard->tiles[idx] = tile;
+static void MoveTile(GameBoard *gameBoard, uint32_t fromIdx, uint32_t toIdx, int perTile) {
+    AddTileCore(gameBoard, toIdx, gameBoard->cells[fromIdx], perTile);
+    RemoveTile(gameBoard, fromIdx, perTile);
+}
 
-    changeTile = tile;
-    ChangeHandlerNotifyListeners(gameBoard->addRemoveListeners);
-    changeTile = 0;
+static void MergeTile(GameBoard *gameBoard, uint32_t fromIdx, uint32_t toIdx, int perTile) {
+    LOG_ASSERTMSG_REASON(gameBoard->cells[toIdx] < TILE_MAX_EXPONENT, "tile value out of range", InvalidOperationReason);
+    gameBoard->cells[toIdx]++;
+    if (!gameBoard->headless && gameBoard->handles && gameBoard->handles[toIdx]) {
+        TileNotifyValueChanged(gameBoard->handles[toIdx]);
+    }
+    RemoveTile(gameBoard, fromIdx, perTile);
 }
 
 void GameBoardAddTile(GameBoard *gameBoard, uint32_t row, uint32_t col) {
     LOG_ASSERT_REASON(GameBoardCanAddTile(gameBoard, row, col), InvalidOperationReason);
-    Tile *t = TileCreate(row, col);
-    AddTileCore(gameBoard, t);
+    uint32_t idx = MakeBoardIndex(gameBoard, row, col);
+    int coalescing = IsCoalescing(gameBoard);
+    // TODO: tile can sometimes start with 2 or 4.
+    AddTileCore(gameBoard, idx, 1, SendsPerTileNotifications(gameBoard));
+
+    if (coalescing) {
+        BeginDiff(gameBoard);
+        RecordChange(gameBoard, BoardChangeAdd, idx, idx);
+        EmitDiff(gameBoard);
+    }
+}
+
+uint64_t GameBoardGetScore(GameBoard *gameBoard) {
+    LOG_ASSERT_REASON(gameBoard, ArgumentNullReason);
+    return gameBoard->score;
 }
 
 int GameBoardTrySlide(GameBoard *gameBoard, SlideDirection direction) {
+    return GameBoardTrySlideWithScore(gameBoard, direction, 0);
+}
+
+static void BuildSlideDiff(GameBoard *gameBoard, uint32_t numMerges) {
+    // Merges were recorded as they happened, keyed by the original index of each tile. Now that
+    // every tile has settled, turn those into final cells and add a Move for each tile that moved.
+    uint32_t numCells = gameBoard->numRows * gameBoard->numCols;
+    for (uint32_t idx = 0; idx < numCells; idx++) {
+        if (gameBoard->cells[idx]) {
+            gameBoard->finalIndices[gameBoard->origins[idx]] = idx;
+        }
+    }
+
+    for (uint32_t i = 0; i < numMerges; i++) {
+        BoardChange *merge = &gameBoard->changes[i];
+        uint32_t consumerOrigin = merge->to.col + merge->to.row * gameBoard->numCols;
+        merge->to = IndexToCell(gameBoard, gameBoard->finalIndices[consumerOrigin]);
+        merge->exponent = gameBoard->cells[gameBoard->finalIndices[consumerOrigin]];
+    }
+
+    for (uint32_t idx = 0; idx < numCells; idx++) {
+        if (gameBoard->cells[idx] && gameBoard->origins[idx] != idx) {
+            RecordChange(gameBoard, BoardChangeMove, gameBoard->origins[idx], idx);
+        }
+    }
+}
+
+// The headless slide loop on the column mirror: no handles, diffs or origins to keep, just bytes.
+static int SlideColumns(GameBoard *gameBoard, SlideDirection direction, uint64_t *delta) {
+    uint32_t rows = gameBoard->numRows;
+    uint32_t cols = gameBoard->numCols;
+    uint32_t numPairs = (rows - 1) * cols;
+    const CellIndexPair *pairs = gameBoard->columnPairs[direction];
+    uint8_t *columns = gameBoard->columns;
+    uint8_t *merged = gameBoard->merged;
+
+    Transpose(gameBoard->cells, columns, rows, cols);
+    memset(merged, 0, rows * cols);
+    int slidOnce = 0, didSlide = 0;
+    do {
+        slidOnce = 0;
+        for (uint32_t i = 0; i < numPairs; i++) {
+            uint32_t slideIdx = pairs[i].source;
+            uint32_t targetIdx = pairs[i].target;
+            if (!columns[slideIdx]) {
+                continue;
+            }
+
+            if (!columns[targetIdx]) {
+                columns[targetIdx] = columns[slideIdx];
+                merged[targetIdx] = merged[slideIdx];
+            } else if (columns[targetIdx] == columns[slideIdx] && !merged[slideIdx] && !merged[targetIdx]) {
+                LOG_ASSERTMSG_REASON(columns[targetIdx] < TILE_MAX_EXPONENT, "tile value out of range", InvalidOperationReason);
+                *delta += ExponentToScore(++columns[targetIdx]);
+                merged[targetIdx] = 1;
+            } else {
+                continue;
+            }
+            columns[slideIdx] = 0;
+            merged[slideIdx] = 0;
+            didSlide = slidOnce |= 1;
+        }
+    } while(slidOnce);
+
+    if (didSlide) {
+        Transpose(columns, gameBoard->cells, cols, rows);
+    }
+    return didSlide;
+}
+
+int GameBoardTrySlideWithScore(GameBoard *gameBoard, SlideDirection direction, uint64_t *scoreDelta) {
     LOG_ASSERT_REASON(gameBoard && gameBoard->slideHandlers[direction], ArgumentNullReason);
 
+    if (gameBoard->headless && gameBoard->columns && (direction == SlideUp || direction == SlideDown)) {
+        uint64_t delta = 0;
+        int didSlide = SlideColumns(gameBoard, direction, &delta);
+        gameBoard->score += delta;
+        if (scoreDelta) {
+            *scoreDelta = delta;
+        }
+        return didSlide;
+    }
+
     int slidOnce = 0, didSlide = 0;
-    ListType mergedTiles = ListCreate(sizeof(Tile *));
-    NextCellGenerator *generator = gameBoard->slideHandlers[direction];
+    uint64_t delta = 0;
+    uint32_t numCells = gameBoard->numRows * gameBoard->numCols;
+    uint32_t *origins = gameBoard->origins;
+    uint8_t *merged = gameBoard->merged;
+    uint8_t *cells = gameBoard->cells;
+    const CellIndexPair *pairs;
+    uint32_t numPairs = CellGeneratorGetPairs(gameBoard->slideHandlers[direction], &pairs);
+
+    // Read once: listeners may come and go from other threads while we slide.
+    int coalescing = IsCoalescing(gameBoard);
+    int perTile = SendsPerTileNotifications(gameBoard);
+    if (coalescing) {
+        for (uint32_t idx = 0; idx < numCells; idx++) {
+            origins[idx] = idx;
+        }
+    }
+    memset(merged, 0, numCells);
+    BeginDiff(gameBoard);
 
     do {
         slidOnce = 0;
-        CellGeneratorReset(generator);
-        while(CellGeneratorMoveNext(generator)) {
-            GameBoardCell toSlide, target;
-            CellGeneratorGetCurrent(generator, &toSlide, &target);
-
-            Tile *targetTile = GameBoardGetTile(gameBoard, target.row, target.col);
-            Tile *slideTile = GameBoardGetTile(gameBoard, toSlide.row, toSlide.col);
-            if (!targetTile && !slideTile) {
+        for (uint32_t i = 0; i < numPairs; i++) {
+            uint32_t slideIdx = pairs[i].source;
+            uint32_t targetIdx = pairs[i].target;
+            if (!cells[slideIdx]) {
                 continue;
             }
 
-            if (!targetTile) {
-                AddTileCore(gameBoard, TileCopyTo(slideTile, target.row, target.col));
-                RemoveTile(gameBoard, slideTile);
+            if (!cells[targetIdx]) {
+                MoveTile(gameBoard, slideIdx, targetIdx, perTile);
+                origins[targetIdx] = origins[slideIdx];
+                merged[targetIdx] = merged[slideIdx];
+                merged[slideIdx] = 0;
                 didSlide = slidOnce |= 1;
                 continue;
             }
 
             int canMerge =
-                slideTile != 0 &&
-                TileCanMerge(targetTile, slideTile) &&
-                !ListFindItem(mergedTiles, &slideTile, FRONT_OF_LIST, 0) &&
-                !ListFindItem(mergedTiles, &targetTile, FRONT_OF_LIST, 0);
+                cells[targetIdx] == cells[slideIdx] &&
+                !merged[slideIdx] &&
+                !merged[targetIdx];
             if (canMerge) {
-                TileMerge(targetTile, slideTile);
-                RemoveTile(gameBoard, slideTile);
-                ListInsertItem(mergedTiles, &targetTile, END_OF_LIST);
+                MergeTile(gameBoard, slideIdx, targetIdx, perTile);
+                delta += ExponentToScore(cells[targetIdx]);
+                if (coalescing) {
+                    // Park the consumer's original index in to; BuildSlideDiff resolves it later.
+                    BoardChange change = {
+                        .kind = BoardChangeMerge,
+                        .from = IndexToCell(gameBoard, origins[slideIdx]),
+                        .to = IndexToCell(gameBoard, origins[targetIdx])
+                    };
+                    gameBoard->changes[gameBoard->diff.numChanges++] = change;
+                }
+                merged[targetIdx] = 1;
+                merged[slideIdx] = 0;
                 didSlide = slidOnce |= 1;
             }
         }
     } while(slidOnce);
-    ListDispose(mergedTiles);
+
+    gameBoard->score += delta;
+    if (scoreDelta) {
+        *scoreDelta = delta;
+    }
+
+    if (coalescing) {
+        BuildSlideDiff(gameBoard, gameBoard->diff.numChanges);
+        gameBoard->diff.scoreDelta = delta;
+        EmitDiff(gameBoard);
+    }
     return didSlide;
 }
+
+int GameBoardCanSlide(GameBoard *gameBoard, SlideDirection direction) {
+    uint32_t numLines = GameBoardNumLines(gameBoard, direction);
+    for (uint32_t i = 0; i < numLines; i++) {
+        BoardLine line = GameBoardGetLine(gameBoard, direction, i);
+        const uint8_t *cell = line.cells;
+        for (uint32_t j = 1; j < line.length; j++) {
+            uint8_t ahead = *cell;
+            cell += line.stride;
+            // A tile slides if there is a gap in front of it or a matching tile to merge with.
+            if (*cell && (!ahead || ahead == *cell)) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+uint32_t GameBoardNumLines(GameBoard *gameBoard, SlideDirection direction) {
+    LOG_ASSERT_REASON(gameBoard, ArgumentNullReason);
+    return direction == SlideUp || direction == SlideDown ? gameBoard->numCols : gameBoard->numRows;
+}
+
+BoardLine GameBoardGetLine(GameBoard *gameBoard, SlideDirection direction, uint32_t line) {
+    LOG_ASSERT_REASON(line < GameBoardNumLines(gameBoard, direction), ArgumentOutOfRangeReason);
+    uint32_t rows = gameBoard->numRows;
+    uint32_t cols = gameBoard->numCols;
+    BoardLine span = { 0 };
+    switch (direction) {
+        case SlideUp:
+            span = (BoardLine){ .cells = &gameBoard->cells[line], .stride = cols, .length = rows };
+            break;
+        case SlideDown:
+            span = (BoardLine){ .cells = &gameBoard->cells[line + (rows - 1) * cols], .stride = -(ptrdiff_t)cols, .length = rows };
+            break;
+        case SlideLeft:
+            span = (BoardLine){ .cells = &gameBoard->cells[line * cols], .stride = 1, .length = cols };
+            break;
+        case SlideRight:
+            span = (BoardLine){ .cells = &gameBoard->cells[line * cols + cols - 1], .stride = -1, .length = cols };
+            break;
+        default:
+            LOG_ASSERTMSG_REASON(0, "invalid slide direction!", ArgumentOutOfRangeReason);
+            break;
+    }
+    return span;
+}
+
+size_t GameBoardSnapshotSize(GameBoard *gameBoard) {
+    LOG_ASSERT_REASON(gameBoard, ArgumentNullReason);
+    return sizeof(GameBoardSnapshotHeader) + gameBoard->numRows * gameBoard->numCols;
+}
+
+size_t GameBoardSaveSnapshot(GameBoard *gameBoard, void *buffer, size_t bufferSize) {
+    LOG_ASSERT_REASON(gameBoard && buffer, ArgumentNullReason);
+    size_t size = GameBoardSnapshotSize(gameBoard);
+    if (bufferSize < size) {
+        return 0;
+    }
+
+    GameBoardSnapshotHeader header = {
+        .magic = GAMEBOARD_SNAPSHOT_MAGIC,
+        .version = GAMEBOARD_SNAPSHOT_VERSION,
+        .headerSize = sizeof(GameBoardSnapshotHeader),
+        .numRows = gameBoard->numRows,
+        .numCols = gameBoard->numCols,
+        .score = gameBoard->score,
+        .rngState = gameBoard->rngState
+    };
+    memcpy(buffer, &header, sizeof(header));
+
+    memcpy((uint8_t *)buffer + sizeof(header), gameBoard->cells, gameBoard->numRows * gameBoard->numCols);
+    return size;
+}
+
+static const GameBoardSnapshotHeader *ValidateSnapshot(const void *snapshot, size_t snapshotSize) {
+    if (!snapshot || snapshotSize < sizeof(GameBoardSnapshotHeader)) {
+        return 0;
+    }
+    const GameBoardSnapshotHeader *header = (const GameBoardSnapshotHeader *)snapshot;
+    int valid =
+        header->magic == GAMEBOARD_SNAPSHOT_MAGIC &&
+        header->version == GAMEBOARD_SNAPSHOT_VERSION &&
+        header->headerSize == sizeof(GameBoardSnapshotHeader) &&
+        header->numRows && header->numCols &&
+        header->numRows <= GAMEBOARD_SNAPSHOT_MAX_DIMENSION && header->numCols <= GAMEBOARD_SNAPSHOT_MAX_DIMENSION &&
+        header->numRows <= SIZE_MAX / header->numCols &&
+        (size_t)header->numRows * header->numCols <= snapshotSize - sizeof(GameBoardSnapshotHeader);
+    return valid ? header : 0;
+}
+
+int GameBoardRestoreSnapshot(GameBoard *gameBoard, const void *snapshot, size_t snapshotSize, SnapshotRestoreMode mode) {
+    LOG_ASSERT_REASON(gameBoard, ArgumentNullReason);
+    const GameBoardSnapshotHeader *header = ValidateSnapshot(snapshot, snapshotSize);
+    if (!header || header->numRows != gameBoard->numRows || header->numCols != gameBoard->numCols) {
+        return 0;
+    }
+
+    const uint8_t *cells = (const uint8_t *)snapshot + header->headerSize;
+    int notifyPerTile = mode == RestoreNotifyPerTile;
+    // Read once: listeners may come and go from other threads while we restore.
+    int coalescing = IsCoalescing(gameBoard);
+    int perTile = SendsPerTileNotifications(gameBoard);
+    BeginDiff(gameBoard);
+    uint32_t numCells = gameBoard->numRows * gameBoard->numCols;
+    if (!notifyPerTile) {
+        memcpy(gameBoard->cells, cells, numCells);
+        ClearAllTileHandlers(gameBoard);
+    }
+    for (uint32_t idx = 0; notifyPerTile && idx < numCells; idx++) {
+        if (gameBoard->cells[idx] == cells[idx]) {
+            continue;
+        }
+        if (gameBoard->cells[idx]) {
+            // Record first so the change carries the exponent being removed.
+            if (coalescing) {
+                RecordChange(gameBoard, BoardChangeRemove, idx, idx);
+            }
+            RemoveTile(gameBoard, idx, perTile);
+        }
+        if (cells[idx]) {
+            AddTileCore(gameBoard, idx, cells[idx], perTile);
+            if (coalescing) {
+                RecordChange(gameBoard, BoardChangeAdd, idx, idx);
+            }
+        }
+    }
+    gameBoard->score = header->score;
+    gameBoard->rngState = header->rngState;
+
+    if (!notifyPerTile && !gameBoard->headless) {
+        NotifyReset(gameBoard);
+    } else if (coalescing) {
+        EmitDiff(gameBoard);
+    }
+    return 1;
+}
+
+GameBoard *GameBoardCreateFromSnapshot(const void *snapshot, size_t snapshotSize) {
+    const GameBoardSnapshotHeader *header = ValidateSnapshot(snapshot, snapshotSize);
+    if (!header) {
+        return 0;
+    }
+    GameBoard *gb = GameBoardCreate(header->numRows, header->numCols);
+    GameBoardRestoreSnapshot(gb, snapshot, snapshotSize, RestoreNotifyReset);
+    return gb;
+}
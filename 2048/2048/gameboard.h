@@ -15,12 +15,14 @@
     extern "C" {
 #endif
 
+#include <stddef.h>
 #include "cvidef.h"
 #include "tile.h"
 
 typedef enum AddRemoveReason {
     Added,
-    Removed
+    Removed,
+    Reset
 } AddRemoveReason;
 
 typedef enum SlideDirection {
@@ -30,6 +32,13 @@ typedef enum SlideDirection {
     SlideRight
 } SlideDirection;
 
+typedef enum SnapshotRestoreMode {
+    RestoreNotifyPerTile = 0,
+    RestoreNotifyReset
+} SnapshotRestoreMode;
+
+// A Reset notification is sent with a NULL tile. Every tile on the board has had its value change
+// handlers cleared, so handlers should re-read (and re-subscribe to) the whole board.
 typedef void (*AddRemoveTileHandler)(Tile *tile, AddRemoveReason reason, void *data);
 
 typedef struct GameBoardCell {
@@ -39,14 +48,89 @@ typedef struct GameBoardCell {
 
 typedef struct GameBoard GameBoard;
 
+typedef enum BoardChangeKind {
+    BoardChangeMove,
+    BoardChangeMerge,
+    BoardChangeAdd,
+    BoardChangeRemove
+} BoardChangeKind;
+
+// For a Move, the tile at from now sits at to. For a Merge, the tile that started at from was
+// consumed by the tile now at to (after that tile's own Move, if any). Add and Remove only use to.
+// exponent is the tile exponent at to once the whole diff has been applied; a Remove instead carries
+// the exponent of the tile it removed.
+typedef struct BoardChange {
+    BoardChangeKind kind;
+    GameBoardCell from;
+    GameBoardCell to;
+    uint8_t exponent;
+} BoardChange;
+
+typedef struct BoardDiff {
+    uint32_t numChanges;
+    const BoardChange *changes;
+    uint64_t scoreDelta;
+} BoardDiff;
+
+// Diff handlers get slides, added tiles and per-tile restores as one BoardDiff per call. Add/remove
+// handlers keep getting their per-tile notifications either way; each listener opts into the form
+// it wants by which handler it registers.
+typedef void (*BoardDiffHandler)(GameBoard *gameBoard, const BoardDiff *diff, void *data);
+
+// Sent whenever add/remove handlers get a Reset, so a diff listener can resync without also
+// taking per-tile notifications.
+typedef void (*BoardResetHandler)(GameBoard *gameBoard, void *data);
+
+// One row or column of exponents in slide order: cells[0] is on the edge tiles slide toward and
+// each next cell is stride bytes further away. Only valid until the board next changes.
+typedef struct BoardLine {
+    const uint8_t *cells;
+    ptrdiff_t stride;
+    uint32_t length;
+} BoardLine;
+
+#define GAMEBOARD_SNAPSHOT_MAGIC 0x38343032
+#define GAMEBOARD_SNAPSHOT_VERSION 1
+// Snapshots claiming more rows or columns than this are rejected before their size is trusted.
+#define GAMEBOARD_SNAPSHOT_MAX_DIMENSION 0x8000
+
+// Fixed layout, followed directly by numRows * numCols cell exponents (one byte each, 0 for an empty cell).
+typedef struct GameBoardSnapshotHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t numRows;
+    uint32_t numCols;
+    uint64_t score;
+    uint32_t rngState;
+    uint32_t reserved;
+} GameBoardSnapshotHeader;
+
 GameBoard *GameBoardCreate(uint32_t numRows, uint32_t numCols);
 void GameBoardDispose(GameBoard *gameBoard);
 
 uint32_t GameBoardNumRows(GameBoard *gameBoard);
 uint32_t GameBoardNumCols(GameBoard *gameBoard);
+void GameBoardSetSeed(GameBoard *gameBoard, uint32_t seed);
 
-void GameBoardAddTileAddRemoveHandler(GameBoard *gameBoard, void *data, AddRemoveTileHandler handler);
+ListenerHandle GameBoardAddTileAddRemoveHandler(GameBoard *gameBoard, void *data, AddRemoveTileHandler handler);
 void GameBoardRemoveTileAddRemoveHandler(GameBoard *gameBoard, AddRemoveTileHandler handler);
+void GameBoardRemoveTileAddRemoveHandlerByHandle(GameBoard *gameBoard, ListenerHandle handle);
+// A headless board sends no add/remove, reset or diff notifications and skips the bookkeeping behind
+// them. Turning headless mode off sends a single Reset so listeners can resync with the board.
+void GameBoardSetHeadless(GameBoard *gameBoard, int headless);
+int GameBoardIsHeadless(GameBoard *gameBoard);
+// Keeps a column-major copy of the cells so vertical slides on headless boards walk memory with
+// unit stride. The copy is rebuilt at the start of each vertical slide, so it pays off on wide
+// boards; boards with listeners always slide in place.
+void GameBoardSetColumnMirror(GameBoard *gameBoard, int enabled);
+int GameBoardUsesColumnMirror(GameBoard *gameBoard);
+
+ListenerHandle GameBoardAddDiffHandler(GameBoard *gameBoard, void *data, BoardDiffHandler handler);
+void GameBoardRemoveDiffHandler(GameBoard *gameBoard, BoardDiffHandler handler);
+void GameBoardRemoveDiffHandlerByHandle(GameBoard *gameBoard, ListenerHandle handle);
+ListenerHandle GameBoardAddResetHandler(GameBoard *gameBoard, void *data, BoardResetHandler handler);
+void GameBoardRemoveResetHandlerByHandle(GameBoard *gameBoard, ListenerHandle handle);
 
 GameBoardCell GameBoardMakeCell(int row, int col);
 int GameBoardTryGetOpenCell(GameBoard *gameBoard, GameBoardCell *cell);
@@ -54,9 +138,23 @@ int GameBoardIsValidCell(GameBoard *gameBoard, GameBoardCell cell);
 
 int GameBoardCanAddTile(GameBoard *gameBoard, uint32_t row, uint32_t col);
 void GameBoardAddTile(GameBoard *gameBoard, uint32_t row, uint32_t col);
+// Returns a handle that stays valid for the life of the board, or NULL for an empty cell.
 Tile *GameBoardGetTile(GameBoard *gameBoard, uint32_t row, uint32_t column);
+// The cell's exponent, 0 when empty. Cheaper than a tile handle for anything that only reads.
+uint8_t GameBoardGetExponent(GameBoard *gameBoard, uint32_t row, uint32_t column);
 
 int GameBoardTrySlide(GameBoard *gameBoard, SlideDirection direction);
+int GameBoardTrySlideWithScore(GameBoard *gameBoard, SlideDirection direction, uint64_t *scoreDelta);
+int GameBoardCanSlide(GameBoard *gameBoard, SlideDirection direction);
+
+uint32_t GameBoardNumLines(GameBoard *gameBoard, SlideDirection direction);
+BoardLine GameBoardGetLine(GameBoard *gameBoard, SlideDirection direction, uint32_t line);
+uint64_t GameBoardGetScore(GameBoard *gameBoard);
+
+size_t GameBoardSnapshotSize(GameBoard *gameBoard);
+size_t GameBoardSaveSnapshot(GameBoard *gameBoard, void *buffer, size_t bufferSize);
+int GameBoardRestoreSnapshot(GameBoard *gameBoard, const void *snapshot, size_t snapshotSize, SnapshotRestoreMode mode);
+GameBoard *GameBoardCreateFromSnapshot(const void *snapshot, size_t snapshotSize);
 
 #ifdef __cplusplus
     }
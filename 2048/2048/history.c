@@ -0,0 +1,224 @@
+#include <ansi_c.h>
+#include "history.h"
+#include "../../CVI_Core/log.h"
+
+// A delta record: score, random state and change count, then the changes, then the record's
+// length again so the stack can be walked back from its newest record.
+typedef struct DeltaHeader {
+    uint64_t score;
+    uint32_t rngState;
+    uint32_t numChanges;
+} DeltaHeader;
+
+typedef struct HistoryStack {
+    // The newest step in full.
+    uint8_t *top;
+    uint64_t topScore;
+    uint32_t topRngState;
+    // Every older step as the changes that turn the step above it back into it, oldest first.
+    uint8_t *deltas;
+    size_t start;
+    size_t end;
+    size_t capacity;
+    size_t count;
+} HistoryStack;
+
+struct GameHistory {
+    uint32_t numRows;
+    uint32_t numCols;
+    uint32_t numCells;
+    // A change is a cell index, 2 bytes on boards up to 65536 cells and 4 beyond, then an exponent.
+    uint32_t indexBytes;
+    uint32_t maxDepth;
+    HistoryStack undo;
+    HistoryStack redo;
+};
+
+static size_t RecordSize(GameHistory *history, uint32_t numChanges) {
+    return sizeof(DeltaHeader) + (size_t)numChanges * (history->indexBytes + 1) + sizeof(uint32_t);
+}
+
+static void ClearStack(HistoryStack *stack) {
+    stack->start = 0;
+    stack->end = 0;
+    stack->count = 0;
+}
+
+static void ReserveDeltas(HistoryStack *stack, size_t length) {
+    if (stack->end + length <= stack->capacity) {
+        return;
+    }
+    // Reclaim the space left behind by capped steps before growing.
+    if (stack->start) {
+        memmove(stack->deltas, stack->deltas + stack->start, stack->end - stack->start);
+        stack->end -= stack->start;
+        stack->start = 0;
+    }
+    if (stack->end + length > stack->capacity) {
+        stack->capacity = stack->capacity * 2 > stack->end + length ? stack->capacity * 2 : stack->end + length;
+        stack->deltas = realloc(stack->deltas, stack->capacity);
+    }
+}
+
+static void DropOldestStep(GameHistory *history, HistoryStack *stack) {
+    DeltaHeader header;
+    memcpy(&header, stack->deltas + stack->start, sizeof(header));
+    stack->start += RecordSize(history, header.numChanges);
+    stack->count--;
+}
+
+static void PushStep(GameHistory *history, HistoryStack *stack, const void *snapshot, size_t snapshotSize) {
+    const GameBoardSnapshotHeader *header = (const GameBoardSnapshotHeader *)snapshot;
+    LOG_ASSERT_REASON(snapshotSize >= sizeof(*header) + history->numCells, ArgumentOutOfRangeReason);
+    LOG_ASSERT_REASON(header->numRows == history->numRows && header->numCols == history->numCols, InvalidOperationReason);
+    const uint8_t *cells = (const uint8_t *)snapshot + header->headerSize;
+
+    if (stack->count) {
+        // The old top becomes a record of the cells that differ from the new one.
+        uint32_t numChanges = 0;
+        for (uint32_t idx = 0; idx < history->numCells; idx++) {
+            numChanges += cells[idx] != stack->top[idx];
+        }
+        size_t length = RecordSize(history, numChanges);
+        ReserveDeltas(stack, length);
+
+        uint8_t *record = stack->deltas + stack->end;
+        DeltaHeader delta = { .score = stack->topScore, .rngState = stack->topRngState, .numChanges = numChanges };
+        memcpy(record, &delta, sizeof(delta));
+        uint8_t *change = record + sizeof(delta);
+        for (uint32_t idx = 0; idx < history->numCells; idx++) {
+            if (cells[idx] != stack->top[idx]) {
+                memcpy(change, &idx, history->indexBytes);
+                change[history->indexBytes] = stack->top[idx];
+                change += history->indexBytes + 1;
+            }
+        }
+        uint32_t length32 = (uint32_t)length;
+        memcpy(change, &length32, sizeof(length32));
+        stack->end += length;
+    }
+
+    memcpy(stack->top, cells, history->numCells);
+    stack->topScore = header->score;
+    stack->topRngState = header->rngState;
+    stack->count++;
+    if (stack->count > history->maxDepth) {
+        DropOldestStep(history, stack);
+    }
+}
+
+static int PopStep(GameHistory *history, HistoryStack *stack, void *snapshot, size_t snapshotSize) {
+    if (!stack->count || snapshotSize < sizeof(GameBoardSnapshotHeader) + history->numCells) {
+        return 0;
+    }
+
+    GameBoardSnapshotHeader header = {
+        .magic = GAMEBOARD_SNAPSHOT_MAGIC,
+        .version = GAMEBOARD_SNAPSHOT_VERSION,
+        .headerSize = sizeof(GameBoardSnapshotHeader),
+        .numRows = history->numRows,
+        .numCols = history->numCols,
+        .score = stack->topScore,
+        .rngState = stack->topRngState
+    };
+    memcpy(snapshot, &header, sizeof(header));
+    memcpy((uint8_t *)snapshot + sizeof(header), stack->top, history->numCells);
+
+    stack->count--;
+    if (!stack->count) {
+        ClearStack(stack);
+        return 1;
+    }
+
+    // Rebuild the step below from its record.
+    uint32_t length;
+    memcpy(&length, stack->deltas + stack->end - sizeof(length), sizeof(length));
+    stack->end -= length;
+    const uint8_t *record = stack->deltas + stack->end;
+    DeltaHeader delta;
+    memcpy(&delta, record, sizeof(delta));
+    const uint8_t *change = record + sizeof(delta);
+    for (uint32_t i = 0; i < delta.numChanges; i++, change += history->indexBytes + 1) {
+        uint32_t idx = 0;
+        memcpy(&idx, change, history->indexBytes);
+        stack->top[idx] = change[history->indexBytes];
+    }
+    stack->topScore = delta.score;
+    stack->topRngState = delta.rngState;
+    return 1;
+}
+
+GameHistory *GameHistoryCreate(uint32_t numRows, uint32_t numCols) {
+    LOG_ASSERT_REASON(numRows && numCols, ArgumentOutOfRangeReason);
+    GameHistory *history = calloc(1, sizeof(GameHistory));
+    history->numRows = numRows;
+    history->numCols = numCols;
+    history->numCells = numRows * numCols;
+    history->indexBytes = history->numCells > 0x10000 ? 4 : 2;
+    history->maxDepth = GAME_HISTORY_DEFAULT_DEPTH;
+    history->undo.top = calloc(history->numCells, sizeof(uint8_t));
+    history->redo.top = calloc(history->numCells, sizeof(uint8_t));
+    return history;
+}
+
+void GameHistoryDispose(GameHistory *history) {
+    if (!history) {
+        return;
+    }
+    free(history->undo.top);
+    free(history->undo.deltas);
+    free(history->redo.top);
+    free(history->redo.deltas);
+    free(history);
+}
+
+void GameHistorySetMaxDepth(GameHistory *history, uint32_t maxDepth) {
+    LOG_ASSERT_REASON(history, ArgumentNullReason);
+    LOG_ASSERT_REASON(maxDepth, ArgumentOutOfRangeReason);
+    history->maxDepth = maxDepth;
+    while (history->undo.count > maxDepth) {
+        DropOldestStep(history, &history->undo);
+    }
+    while (history->redo.count > maxDepth) {
+        DropOldestStep(history, &history->redo);
+    }
+}
+
+size_t GameHistoryBytesUsed(GameHistory *history) {
+    LOG_ASSERT_REASON(history, ArgumentNullReason);
+    return 2 * (size_t)history->numCells + history->undo.capacity + history->redo.capacity;
+}
+
+void GameHistoryPush(GameHistory *history, const void *snapshot, size_t snapshotSize) {
+    LOG_ASSERT_REASON(history && snapshot, ArgumentNullReason);
+    PushStep(history, &history->undo, snapshot, snapshotSize);
+    ClearStack(&history->redo);
+}
+
+int GameHistoryCanUndo(GameHistory *history) {
+    LOG_ASSERT_REASON(history, ArgumentNullReason);
+    return history->undo.count != 0;
+}
+
+int GameHistoryCanRedo(GameHistory *history) {
+    LOG_ASSERT_REASON(history, ArgumentNullReason);
+    return history->redo.count != 0;
+}
+
+int GameHistoryUndo(GameHistory *history, const void *current, void *snapshot, size_t snapshotSize) {
+    LOG_ASSERT_REASON(history && current && snapshot, ArgumentNullReason);
+    if (!history->undo.count) {
+        return 0;
+    }
+    PushStep(history, &history->redo, current, snapshotSize);
+    return PopStep(history, &history->undo, snapshot, snapshotSize);
+}
+
+int GameHistoryRedo(GameHistory *history, const void *current, void *snapshot, size_t snapshotSize) {
+    LOG_ASSERT_REASON(history && current && snapshot, ArgumentNullReason);
+    if (!history->redo.count) {
+        return 0;
+    }
+    PushStep(history, &history->undo, current, snapshotSize);
+    return PopStep(history, &history->redo, snapshot, snapshotSize);
+}
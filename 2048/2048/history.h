@@ -0,0 +1,36 @@
+#ifndef __history_H__
+#define __history_H__
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#include <stddef.h>
+#include "cvidef.h"
+#include "gameboard.h"
+
+// Delta-encoded undo/redo stacks of board snapshots. Each stack keeps its newest step in full and
+// every older step as the cells that differ from the step above it, a few bytes for a typical move.
+// Each stack keeps at most maxDepth steps and forgets the oldest beyond that.
+typedef struct GameHistory GameHistory;
+
+#define GAME_HISTORY_DEFAULT_DEPTH 1024
+
+GameHistory *GameHistoryCreate(uint32_t numRows, uint32_t numCols);
+void GameHistoryDispose(GameHistory *history);
+
+void GameHistorySetMaxDepth(GameHistory *history, uint32_t maxDepth);
+size_t GameHistoryBytesUsed(GameHistory *history);
+
+void GameHistoryPush(GameHistory *history, const void *snapshot, size_t snapshotSize);
+
+int GameHistoryCanUndo(GameHistory *history);
+int GameHistoryCanRedo(GameHistory *history);
+int GameHistoryUndo(GameHistory *history, const void *current, void *snapshot, size_t snapshotSize);
+int GameHistoryRedo(GameHistory *history, const void *current, void *snapshot, size_t snapshotSize);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif  /* ndef __history_H__ */
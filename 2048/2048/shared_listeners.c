@@ -0,0 +1,212 @@
+#include <windows.h>
+#include <ansi_c.h>
+#include <utility.h>
+#include <toolbox.h>
+#include "shared_listeners.h"
+#include "../../CVI_Core/log.h"
+
+// Listeners keep their slot for as long as they are registered, so a handle's slot is its index.
+// A removed listener leaves a free slot, generation 0, for the next add to reuse.
+typedef struct ListenerSnapshot {
+    uint32_t numSlots;
+    ListenerSlot slots[];
+} ListenerSnapshot;
+
+typedef struct RetiredItem {
+    struct RetiredItem *next;
+    void *item;
+    ClearDataHandler handleClearData;
+} RetiredItem;
+
+struct SharedListenerList {
+    ListenerSnapshot * volatile current;
+    volatile LONG readers;
+    volatile LONG count;
+    CmtThreadLockHandle lock;
+    uint32_t lastGeneration;
+    // Free slots of the current snapshot are chained through data.data, holding the next free slot + 1.
+    uint32_t firstFree;
+    RetiredItem * volatile retired;
+};
+
+static ListenerSnapshot *LoadSnapshot(SharedListenerList *listeners) {
+    return (ListenerSnapshot *)InterlockedCompareExchangePointer((PVOID volatile *)&listeners->current, 0, 0);
+}
+
+static ListenerSnapshot *CopySnapshot(ListenerSnapshot *snapshot, uint32_t numSlots) {
+    ListenerSnapshot *copy = malloc(sizeof(ListenerSnapshot) + numSlots * sizeof(ListenerSlot));
+    copy->numSlots = numSlots;
+    if (snapshot) {
+        memcpy(copy->slots, snapshot->slots, Min(numSlots, snapshot->numSlots) * sizeof(ListenerSlot));
+    }
+    return copy;
+}
+
+static void Retire(SharedListenerList *listeners, void *item, ClearDataHandler handleClearData) {
+    if (!item || !handleClearData) {
+        return;
+    }
+    RetiredItem *retired = malloc(sizeof(RetiredItem));
+    retired->item = item;
+    retired->handleClearData = handleClearData;
+    retired->next = listeners->retired;
+    listeners->retired = retired;
+}
+
+// Call with the lock held. A dispatch registers as a reader before it loads the snapshot, so once
+// the count reads zero nothing retired so far can still be in use.
+static void Reclaim(SharedListenerList *listeners) {
+    if (!listeners->retired || InterlockedCompareExchange(&listeners->readers, 0, 0) != 0) {
+        return;
+    }
+    RetiredItem *retired = listeners->retired;
+    listeners->retired = 0;
+    while (retired) {
+        RetiredItem *next = retired->next;
+        retired->handleClearData(retired->item);
+        free(retired);
+        retired = next;
+    }
+}
+
+static void Publish(SharedListenerList *listeners, ListenerSnapshot *snapshot, uint32_t count) {
+    ListenerSnapshot *old = (ListenerSnapshot *)InterlockedExchangePointer((PVOID volatile *)&listeners->current, snapshot);
+    InterlockedExchange(&listeners->count, (LONG)count);
+    Retire(listeners, old, free);
+}
+
+static int RemoveSlot(SharedListenerList *listeners, ListenerSnapshot *snapshot, uint32_t slot, ClearDataHandler handleClearData) {
+    void *data = snapshot->slots[slot].data.data;
+    uint32_t count = (uint32_t)listeners->count - 1;
+    ListenerSnapshot *copy = 0;
+    if (count) {
+        copy = CopySnapshot(snapshot, snapshot->numSlots);
+        memset(copy->slots + slot, 0, sizeof(ListenerSlot));
+        copy->slots[slot].data.data = (void *)(uintptr_t)listeners->firstFree;
+        listeners->firstFree = slot + 1;
+    } else {
+        listeners->firstFree = 0;
+    }
+    Publish(listeners, copy, count);
+    Retire(listeners, data, handleClearData);
+    Reclaim(listeners);
+    return 1;
+}
+
+SharedListenerList *SharedListenersCreate(void) {
+    SharedListenerList *listeners = calloc(1, sizeof(SharedListenerList));
+    CmtNewLock(0, 0, &listeners->lock);
+    return listeners;
+}
+
+void SharedListenersDispose(SharedListenerList *listeners, ClearDataHandler handleClearData) {
+    LOG_ASSERT_REASON(listeners, ArgumentNullReason);
+    LOG_ASSERT_REASON(listeners->readers == 0, InvalidOperationReason);
+
+    ListenerSnapshot *snapshot = listeners->current;
+    if (snapshot && handleClearData) {
+        for (uint32_t i = 0; i < snapshot->numSlots; i++) {
+            if (snapshot->slots[i].generation) {
+                handleClearData(snapshot->slots[i].data.data);
+            }
+        }
+    }
+    free(snapshot);
+    Reclaim(listeners);
+    CmtDiscardLock(listeners->lock);
+    free(listeners);
+}
+
+ListenerHandle SharedListenersAdd(SharedListenerList *listeners, ChangeData data) {
+    LOG_ASSERT_REASON(listeners, ArgumentNullReason);
+    LOG_ASSERT_REASON(data.handler, ArgumentNullReason);
+
+    CmtGetLock(listeners->lock);
+    ListenerSnapshot *snapshot = listeners->current;
+    uint32_t slot;
+    ListenerSnapshot *copy;
+    if (listeners->firstFree) {
+        slot = listeners->firstFree - 1;
+        copy = CopySnapshot(snapshot, snapshot->numSlots);
+        listeners->firstFree = (uint32_t)(uintptr_t)copy->slots[slot].data.data;
+    } else {
+        slot = snapshot ? snapshot->numSlots : 0;
+        copy = CopySnapshot(snapshot, slot + 1);
+    }
+    if (!++listeners->lastGeneration) {
+        ++listeners->lastGeneration;
+    }
+    copy->slots[slot].data = data;
+    copy->slots[slot].generation = listeners->lastGeneration;
+    Publish(listeners, copy, (uint32_t)listeners->count + 1);
+    Reclaim(listeners);
+
+    ListenerHandle handle = { .slot = slot, .generation = listeners->lastGeneration };
+    CmtReleaseLock(listeners->lock);
+    return handle;
+}
+
+int SharedListenersRemoveHandle(SharedListenerList *listeners, ListenerHandle handle, ClearDataHandler handleClearData) {
+    LOG_ASSERT_REASON(listeners, ArgumentNullReason);
+    if (!handle.generation) {
+        return 0;
+    }
+
+    int removed = 0;
+    CmtGetLock(listeners->lock);
+    ListenerSnapshot *snapshot = listeners->current;
+    if (snapshot && handle.slot < snapshot->numSlots && snapshot->slots[handle.slot].generation == handle.generation) {
+        removed = RemoveSlot(listeners, snapshot, handle.slot, handleClearData);
+    }
+    CmtReleaseLock(listeners->lock);
+    return removed;
+}
+
+int SharedListenersRemove(SharedListenerList *listeners, ChangeData data, ClearDataHandler handleClearData) {
+    LOG_ASSERT_REASON(listeners, ArgumentNullReason);
+
+    int removed = 0;
+    CmtGetLock(listeners->lock);
+    ListenerSnapshot *snapshot = listeners->current;
+    uint32_t numSlots = snapshot ? snapshot->numSlots : 0;
+    for (uint32_t i = 0; i < numSlots; i++) {
+        if (snapshot->slots[i].generation && snapshot->slots[i].data.target == data.target && snapshot->slots[i].data.handler == data.handler) {
+            removed = RemoveSlot(listeners, snapshot, i, handleClearData);
+            break;
+        }
+    }
+    CmtReleaseLock(listeners->lock);
+    return removed;
+}
+
+uint32_t SharedListenersCount(SharedListenerList *listeners) {
+    LOG_ASSERT_REASON(listeners, ArgumentNullReason);
+    return (uint32_t)listeners->count;
+}
+
+void SharedListenersNotify(SharedListenerList *listeners, void *args) {
+    LOG_ASSERT_REASON(listeners, ArgumentNullReason);
+    if (!listeners->count) {
+        return;
+    }
+
+    InterlockedIncrement(&listeners->readers);
+    ListenerSnapshot *snapshot = LoadSnapshot(listeners);
+    uint32_t numSlots = snapshot ? snapshot->numSlots : 0;
+    for (uint32_t i = 0; i < numSlots; i++) {
+        if (!snapshot->slots[i].generation) {
+            continue;
+        }
+        snapshot->slots[i].data.handler(snapshot->slots[i].data.target, snapshot->slots[i].data.data, args);
+    }
+
+    // The last reader out frees what writers retired in the meantime, unless a writer is busy and will do it.
+    if (InterlockedDecrement(&listeners->readers) == 0 && listeners->retired) {
+        int obtained = 0;
+        CmtTryToGetLock(listeners->lock, &obtained);
+        if (obtained) {
+            Reclaim(listeners);
+            CmtReleaseLock(listeners->lock);
+        }
+    }
+}
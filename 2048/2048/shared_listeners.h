@@ -0,0 +1,36 @@
+#ifndef __shared_listeners_H__
+#define __shared_listeners_H__
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#include <stdint.h>
+#include "cvidef.h"
+#include "change_notification.h"
+
+// A listener list that any thread may add to or remove from while another thread dispatches.
+// Writers serialize on a lock and publish a new immutable copy of the list; dispatch takes no
+// locks and walks whichever copy was current when it started, so changes made during a dispatch
+// take effect on the next one. Replaced copies, and the data of removed listeners, are only
+// released once no dispatch can still be reading them. A listener keeps its slot while registered,
+// so removing by handle goes straight to it; the copy a removal publishes is its only O(n) cost.
+typedef struct SharedListenerList SharedListenerList;
+
+SharedListenerList *SharedListenersCreate(void);
+// No dispatch may be running. Remaining listener data is passed to handleClearData.
+void SharedListenersDispose(SharedListenerList *listeners, ClearDataHandler handleClearData);
+
+ListenerHandle SharedListenersAdd(SharedListenerList *listeners, ChangeData data);
+// Removed data is passed to handleClearData once it is safe to release. Returns 0 for a stale handle.
+int SharedListenersRemoveHandle(SharedListenerList *listeners, ListenerHandle handle, ClearDataHandler handleClearData);
+int SharedListenersRemove(SharedListenerList *listeners, ChangeData data, ClearDataHandler handleClearData);
+uint32_t SharedListenersCount(SharedListenerList *listeners);
+
+void SharedListenersNotify(SharedListenerList *listeners, void *args);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif  /* ndef __shared_listeners_H__ */
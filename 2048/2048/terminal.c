@@ -0,0 +1,413 @@
+#include <windows.h>
+#include <ansi_c.h>
+#include <utility.h>
+#include "terminal.h"
+#include "board_style.h"
+#include "../../CVI_Core/log.h"
+
+#define TILE_WIDTH 7
+#define TILE_HEIGHT 3
+#define TITLE_LINES 1
+#define TITLE_COLOR 0x776E65
+#define KEY_ESCAPE 27
+#define POLL_INTERVAL .01
+
+// Older SDK headers predate console escape sequence input.
+#ifndef ENABLE_VIRTUAL_TERMINAL_INPUT
+#define ENABLE_VIRTUAL_TERMINAL_INPUT 0x0200
+#endif
+
+typedef struct ScreenCell {
+    char ch;
+    int fg;
+    int bg;
+} ScreenCell;
+
+struct Terminal {
+    GameBoard *gameBoard;
+    Controller *controller;
+    GameUpdateHandler updateHandler;
+    TerminalWriter writer;
+    void *writerData;
+    int height;
+    int width;
+    // What the terminal shows and what it should show. A shown cell with ch 0 is unknown.
+    ScreenCell *shown;
+    ScreenCell *wanted;
+    uint8_t *dirtyTiles;
+    int anyDirty;
+    int isUpdating;
+    // Where the terminal's cursor and colours are, or -1 when unknown.
+    int cursorRow;
+    int cursorCol;
+    int fg;
+    int bg;
+    char *out;
+    size_t outLength;
+    size_t outCapacity;
+    uint32_t writeCount;
+    uint64_t bytesWritten;
+};
+
+static void Append(Terminal *terminal, const char *bytes, size_t length) {
+    if (terminal->outLength + length > terminal->outCapacity) {
+        size_t capacity = terminal->outCapacity ? terminal->outCapacity * 2 : 1024;
+        while (capacity < terminal->outLength + length) {
+            capacity *= 2;
+        }
+        terminal->out = realloc(terminal->out, capacity);
+        terminal->outCapacity = capacity;
+    }
+    memcpy(terminal->out + terminal->outLength, bytes, length);
+    terminal->outLength += length;
+}
+
+static void AppendString(Terminal *terminal, const char *text) {
+    Append(terminal, text, strlen(text));
+}
+
+static void SetCell(Terminal *terminal, int row, int col, char ch, int fg, int bg) {
+    if (row < terminal->height && col < terminal->width) {
+        ScreenCell cell = { ch, fg, bg };
+        terminal->wanted[col + row * terminal->width] = cell;
+    }
+}
+
+static void PutText(Terminal *terminal, int row, int col, int width, const char *text, int fg, int bg) {
+    int length = (int)strlen(text);
+    int start = col + (width - length) / 2;
+    for (int i = 0; i < length && i < width; i++) {
+        SetCell(terminal, row, start + i, text[i], fg, bg);
+    }
+}
+
+static void RenderTitle(Terminal *terminal) {
+    char title[64];
+    snprintf(title, sizeof(title), "2048 - Score: %llu", (unsigned long long)GameBoardGetScore(terminal->gameBoard));
+    for (int col = 0; col < terminal->width; col++) {
+        SetCell(terminal, 0, col, ' ', TITLE_COLOR, BOARD_STYLE_BACKGROUND);
+    }
+    PutText(terminal, 0, 0, terminal->width, title, TITLE_COLOR, BOARD_STYLE_BACKGROUND);
+}
+
+static void RenderTile(Terminal *terminal, uint32_t row, uint32_t col) {
+    uint8_t exponent = GameBoardGetExponent(terminal->gameBoard, row, col);
+    int fg = BoardStyleTextColor(exponent);
+    int bg = BoardStyleTileColor(exponent);
+    int top = TITLE_LINES + 1 + row * (TILE_HEIGHT + 1);
+    int left = 1 + col * (TILE_WIDTH + 1);
+    for (int r = 0; r < TILE_HEIGHT; r++) {
+        for (int c = 0; c < TILE_WIDTH; c++) {
+            SetCell(terminal, top + r, left + c, ' ', fg, bg);
+        }
+    }
+    if (exponent != 0) {
+        PutText(terminal, top + TILE_HEIGHT / 2, left, TILE_WIDTH, BoardStyleTileText(exponent), fg, bg);
+    }
+}
+
+static void RenderAll(Terminal *terminal) {
+    for (int i = 0; i < terminal->height * terminal->width; i++) {
+        ScreenCell cell = { ' ', TITLE_COLOR, BOARD_STYLE_BACKGROUND };
+        terminal->wanted[i] = cell;
+    }
+    RenderTitle(terminal);
+    uint32_t numRows = GameBoardNumRows(terminal->gameBoard);
+    uint32_t numCols = GameBoardNumCols(terminal->gameBoard);
+    for (uint32_t row = 0; row < numRows; row++) {
+        for (uint32_t col = 0; col < numCols; col++) {
+            RenderTile(terminal, row, col);
+        }
+    }
+}
+
+static void EmitColors(Terminal *terminal, int fg, int bg) {
+    char sgr[64];
+    if (fg != terminal->fg && bg != terminal->bg) {
+        snprintf(sgr, sizeof(sgr), "\x1b[38;2;%d;%d;%d;48;2;%d;%d;%dm",
+            (fg >> 16) & 0xFF, (fg >> 8) & 0xFF, fg & 0xFF, (bg >> 16) & 0xFF, (bg >> 8) & 0xFF, bg & 0xFF);
+    } else if (fg != terminal->fg) {
+        snprintf(sgr, sizeof(sgr), "\x1b[38;2;%d;%d;%dm", (fg >> 16) & 0xFF, (fg >> 8) & 0xFF, fg & 0xFF);
+    } else if (bg != terminal->bg) {
+        snprintf(sgr, sizeof(sgr), "\x1b[48;2;%d;%d;%dm", (bg >> 16) & 0xFF, (bg >> 8) & 0xFF, bg & 0xFF);
+    } else {
+        return;
+    }
+    AppendString(terminal, sgr);
+    terminal->fg = fg;
+    terminal->bg = bg;
+}
+
+// Spaces only show their background, so a change of text colour alone does not need redrawing.
+static int CellsLookAlike(ScreenCell a, ScreenCell b) {
+    return a.ch == b.ch && a.bg == b.bg && (a.ch == ' ' || a.fg == b.fg);
+}
+
+// Compares one line of the screen and emits the characters that differ. The cursor is only moved
+// when the next change is not where the last one left it.
+static void DiffLine(Terminal *terminal, int row, int firstCol, int lastCol) {
+    for (int col = firstCol; col <= lastCol; col++) {
+        uint32_t idx = col + row * terminal->width;
+        ScreenCell wanted = terminal->wanted[idx];
+        if (CellsLookAlike(wanted, terminal->shown[idx])) {
+            continue;
+        }
+        if (row != terminal->cursorRow || col != terminal->cursorCol) {
+            char move[32];
+            snprintf(move, sizeof(move), "\x1b[%d;%dH", row + 1, col + 1);
+            AppendString(terminal, move);
+        }
+        EmitColors(terminal, wanted.ch == ' ' && terminal->fg != -1 ? terminal->fg : wanted.fg, wanted.bg);
+        Append(terminal, &wanted.ch, 1);
+        terminal->shown[idx] = wanted;
+        terminal->cursorRow = row;
+        terminal->cursorCol = col + 1;
+    }
+}
+
+static void Flush(Terminal *terminal) {
+    if (terminal->outLength == 0) {
+        return;
+    }
+    terminal->writer(terminal->out, terminal->outLength, terminal->writerData);
+    terminal->writeCount++;
+    terminal->bytesWritten += terminal->outLength;
+    terminal->outLength = 0;
+}
+
+static void DrawDirtyTiles(Terminal *terminal) {
+    RenderTitle(terminal);
+    DiffLine(terminal, 0, 0, terminal->width - 1);
+
+    uint32_t numCols = GameBoardNumCols(terminal->gameBoard);
+    uint32_t numCells = GameBoardNumRows(terminal->gameBoard) * numCols;
+    for (uint32_t idx = 0; terminal->anyDirty && idx < numCells; idx++) {
+        if (!terminal->dirtyTiles[idx]) {
+            continue;
+        }
+        terminal->dirtyTiles[idx] = 0;
+        uint32_t row = idx / numCols;
+        uint32_t col = idx % numCols;
+        RenderTile(terminal, row, col);
+        int top = TITLE_LINES + 1 + row * (TILE_HEIGHT + 1);
+        int left = 1 + col * (TILE_WIDTH + 1);
+        for (int r = 0; r < TILE_HEIGHT; r++) {
+            DiffLine(terminal, top + r, left, left + TILE_WIDTH - 1);
+        }
+    }
+    terminal->anyDirty = 0;
+    Flush(terminal);
+}
+
+static void MarkTileDirty(Terminal *terminal, GameBoardCell cell) {
+    terminal->dirtyTiles[cell.col + cell.row * GameBoardNumCols(terminal->gameBoard)] = 1;
+    terminal->anyDirty = 1;
+}
+
+// Changes outside an update are written straight away.
+static void DrawIfNotUpdating(Terminal *terminal) {
+    if (!terminal->isUpdating) {
+        DrawDirtyTiles(terminal);
+    }
+}
+
+static void HandleBeginUpdateGame(void *target, GameBoard *gameBoard) {
+    Terminal *terminal = (Terminal *)target;
+    LOG_ASSERTMSG(!terminal->isUpdating, "Updates should not nest");
+    terminal->isUpdating = 1;
+}
+
+static void HandleEndUpdateGame(void *target, GameBoard *gameBoard) {
+    Terminal *terminal = (Terminal *)target;
+    terminal->isUpdating = 0;
+    DrawDirtyTiles(terminal);
+}
+
+static void HandleTileChange(void *target, Tile *tile) {
+    Terminal *terminal = (Terminal *)target;
+    MarkTileDirty(terminal, GameBoardMakeCell(TileGetRow(tile), TileGetColumn(tile)));
+    DrawIfNotUpdating(terminal);
+}
+
+static void HandleBoardDiff(void *target, GameBoard *gameBoard, const BoardDiff *diff) {
+    Terminal *terminal = (Terminal *)target;
+    for (uint32_t i = 0; i < diff->numChanges; i++) {
+        const BoardChange *change = &diff->changes[i];
+        if (change->kind == BoardChangeMove || change->kind == BoardChangeMerge) {
+            MarkTileDirty(terminal, change->from);
+        }
+        MarkTileDirty(terminal, change->to);
+    }
+    DrawIfNotUpdating(terminal);
+}
+
+static void HandleGameReset(void *target, GameBoard *gameBoard) {
+    Terminal *terminal = (Terminal *)target;
+    memset(terminal->dirtyTiles, 1, GameBoardNumRows(gameBoard) * GameBoardNumCols(gameBoard));
+    terminal->anyDirty = 1;
+    DrawIfNotUpdating(terminal);
+}
+
+Terminal *TerminalCreate(GameBoard *gameBoard, Controller *controller, TerminalWriter writer, void *data) {
+    LOG_ASSERT_REASON(gameBoard && writer, ArgumentNullReason);
+
+    Terminal *terminal = calloc(1, sizeof(Terminal));
+    uint32_t numRows = GameBoardNumRows(gameBoard);
+    uint32_t numCols = GameBoardNumCols(gameBoard);
+    terminal->gameBoard = gameBoard;
+    terminal->controller = controller;
+    terminal->writer = writer;
+    terminal->writerData = data;
+    terminal->height = TITLE_LINES + 1 + numRows * (TILE_HEIGHT + 1);
+    terminal->width = 1 + numCols * (TILE_WIDTH + 1);
+    terminal->shown = calloc(terminal->height * terminal->width, sizeof(ScreenCell));
+    terminal->wanted = calloc(terminal->height * terminal->width, sizeof(ScreenCell));
+    terminal->dirtyTiles = calloc(numRows * numCols, sizeof(uint8_t));
+    if (controller) {
+        terminal->updateHandler.target = terminal;
+        terminal->updateHandler.beginUpdateGame = HandleBeginUpdateGame;
+        terminal->updateHandler.endUpdateGame = HandleEndUpdateGame;
+        terminal->updateHandler.handleTileAdded = HandleTileChange;
+        terminal->updateHandler.handleTileRemoved = HandleTileChange;
+        terminal->updateHandler.handleTileValueChange = HandleTileChange;
+        terminal->updateHandler.handleGameReset = HandleGameReset;
+        terminal->updateHandler.handleBoardDiff = HandleBoardDiff;
+        ControllerSetGameUpdateHandler(controller, &terminal->updateHandler);
+    }
+    TerminalRedraw(terminal);
+    return terminal;
+}
+
+void TerminalDispose(Terminal *terminal) {
+    LOG_ASSERT_REASON(terminal, ArgumentNullReason);
+    if (terminal->controller) {
+        ControllerSetGameUpdateHandler(terminal->controller, 0);
+    }
+    free(terminal->shown);
+    free(terminal->wanted);
+    free(terminal->dirtyTiles);
+    free(terminal->out);
+    free(terminal);
+}
+
+void TerminalRedraw(Terminal *terminal) {
+    LOG_ASSERT_REASON(terminal, ArgumentNullReason);
+
+    memset(terminal->shown, 0, terminal->height * terminal->width * sizeof(ScreenCell));
+    memset(terminal->dirtyTiles, 0, GameBoardNumRows(terminal->gameBoard) * GameBoardNumCols(terminal->gameBoard));
+    terminal->anyDirty = 0;
+    terminal->cursorRow = terminal->cursorCol = -1;
+    terminal->fg = terminal->bg = -1;
+
+    AppendString(terminal, "\x1b[0m\x1b[?25l\x1b[2J");
+    RenderAll(terminal);
+    for (int row = 0; row < terminal->height; row++) {
+        DiffLine(terminal, row, 0, terminal->width - 1);
+    }
+    Flush(terminal);
+}
+
+uint32_t TerminalWriteCount(Terminal *terminal) {
+    LOG_ASSERT_REASON(terminal, ArgumentNullReason);
+    return terminal->writeCount;
+}
+
+uint64_t TerminalBytesWritten(Terminal *terminal) {
+    LOG_ASSERT_REASON(terminal, ArgumentNullReason);
+    return terminal->bytesWritten;
+}
+
+static void WriteToStdout(const char *bytes, size_t length, void *data) {
+    fwrite(bytes, 1, length, stdout);
+    fflush(stdout);
+}
+
+// Reads one key, turning the arrow escape sequences into w/a/s/d.
+static int ReadKey(void) {
+    int key = getchar();
+    if (key != KEY_ESCAPE) {
+        return key;
+    }
+    if (getchar() != '[') {
+        return KEY_ESCAPE;
+    }
+    switch (getchar()) {
+        case 'A': return 'w';
+        case 'B': return 's';
+        case 'C': return 'd';
+        case 'D': return 'a';
+    }
+    return KEY_ESCAPE;
+}
+
+// The spawn after a slide waits on the controller's timers, so they are run out before the next
+// key is read; otherwise the new tile would not show until the player pressed something.
+static void RunPendingTimers(Terminal *terminal) {
+    TimerWheel *timers = ControllerGetTimers(terminal->controller);
+    while (TimerWheelPending(timers)) {
+        Delay(POLL_INTERVAL);
+        TimerWheelPoll(timers);
+    }
+}
+
+static double ReadClock(void) {
+    return Timer();
+}
+
+// Keys arrive one at a time, without echo or Enter, and arrows come through as escape sequences.
+// Returns 0 when stdin is not a console, e.g. piped input, which is read as it is.
+static int EnterRawMode(HANDLE input, DWORD *savedMode) {
+    if (!GetConsoleMode(input, savedMode)) {
+        return 0;
+    }
+    SetConsoleMode(input, (*savedMode & ~(ENABLE_LINE_INPUT | ENABLE_ECHO_INPUT)) | ENABLE_VIRTUAL_TERMINAL_INPUT);
+    return 1;
+}
+
+static void RunTerminal(UserInterface *ui) {
+    LOG_ASSERT_REASON(ui, ArgumentNullReason);
+    Terminal *terminal = (Terminal *)ui->data;
+    TimerWheelSetClock(ControllerGetTimers(terminal->controller), ReadClock);
+
+    HANDLE input = GetStdHandle(STD_INPUT_HANDLE);
+    DWORD savedMode;
+    int raw = EnterRawMode(input, &savedMode);
+    setvbuf(stdin, 0, _IONBF, 0);
+
+    int key;
+    while ((key = ReadKey()) != EOF && key != 'q') {
+        switch (key) {
+            case 'w': ControllerHandleSlide(terminal->controller, SlideUp); break;
+            case 's': ControllerHandleSlide(terminal->controller, SlideDown); break;
+            case 'a': ControllerHandleSlide(terminal->controller, SlideLeft); break;
+            case 'd': ControllerHandleSlide(terminal->controller, SlideRight); break;
+            case 'u': ControllerUndo(terminal->controller); break;
+            case 'r': ControllerRedo(terminal->controller); break;
+        }
+        RunPendingTimers(terminal);
+    }
+
+    if (raw) {
+        SetConsoleMode(input, savedMode);
+    }
+}
+
+static void DisposeTerminal(UserInterface *ui) {
+    LOG_ASSERT_REASON(ui, ArgumentNullReason);
+    Terminal *terminal = (Terminal *)ui->data;
+    char restore[32];
+    snprintf(restore, sizeof(restore), "\x1b[0m\x1b[?25h\x1b[%d;1H", terminal->height + 1);
+    terminal->writer(restore, strlen(restore), terminal->writerData);
+    TerminalDispose(terminal);
+    free(ui);
+}
+
+UserInterface *TerminalCreateUserInterface(Game2048 *game) {
+    LOG_ASSERT_REASON(game, ArgumentNullReason);
+
+    UserInterface *ui = calloc(1, sizeof(UserInterface));
+    ui->data = TerminalCreate(Game2048GameBoard(game), Game2048Controller(game), WriteToStdout, 0);
+    ui->run = RunTerminal;
+    ui->dispose = DisposeTerminal;
+    return ui;
+}
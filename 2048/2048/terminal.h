@@ -0,0 +1,38 @@
+#ifndef __terminal_H__
+#define __terminal_H__
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cvidef.h"
+#include "game.h"
+
+// A UserInterface for ANSI terminals. It keeps a copy of what the terminal is showing and, at the
+// end of each update, writes only the characters that changed, in one write. Cheap enough to watch
+// over a slow remote link.
+typedef struct Terminal Terminal;
+typedef void (*TerminalWriter)(const char *bytes, size_t length, void *data);
+
+// Draws gameBoard through writer, following the controller's updates when one is given.
+Terminal *TerminalCreate(GameBoard *gameBoard, Controller *controller, TerminalWriter writer, void *data);
+void TerminalDispose(Terminal *terminal);
+
+// Clears the terminal and paints everything, for a new viewer or a screen that got out of sync.
+void TerminalRedraw(Terminal *terminal);
+
+uint32_t TerminalWriteCount(Terminal *terminal);
+uint64_t TerminalBytesWritten(Terminal *terminal);
+
+// Writes to stdout and plays from keys on stdin: arrows or w/a/s/d to slide, u/r to undo and redo,
+// q to quit. A console stdin is switched to raw mode for the session so keys arrive without Enter,
+// and put back on return.
+UserInterface *TerminalCreateUserInterface(Game2048 *game);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif  /* ndef __terminal_H__ */
@@ -1,13 +1,14 @@
 #include <toolbox.h>
 #include <stdint.h>
 #include "tile.h"
-#include "change_notification.h"
 #include "../../CVI_Core/log.h"
 
 struct Tile {
     uint32_t row;
     uint32_t col;
-    uint32_t val;
+    // Points at the board's cell for handles, or at exponent for standalone tiles.
+    uint8_t *cell;
+    uint8_t exponent;
     ListenerList valueChangedListeners;
 };
 
@@ -16,27 +17,54 @@ typedef struct TileChangeData {
     void *clientData;
 } TileChangeData;
 
-static void OnTileChanged(void *target, void *data) {
+static void OnTileChanged(void *target, void *data, void *args) {
     Tile *tile = (Tile *)target;
     TileChangeData *d = (TileChangeData *)data;
     d->handler(tile, d->clientData);
 }
 
-static void IncrementValue(Tile *tile, Tile *by) {
-    tile->val += by->val;
-    ChangeHandlerNotifyListeners(tile->valueChangedListeners);
+static void IncrementValue(Tile *tile) {
+    LOG_ASSERTMSG_REASON(*tile->cell < TILE_MAX_EXPONENT, "tile value out of range", InvalidOperationReason);
+    (*tile->cell)++;
+    TileNotifyValueChanged(tile);
 }
 
 Tile *TileCreate(uint32_t row, uint32_t column) {
     Tile *tile = calloc(1, sizeof(Tile));
     // TODO: tile can sometimes start with 2 or 4.
-    tile->val = 2;
+    tile->exponent = 1;
+    tile->cell = &tile->exponent;
     tile->row = row;
     tile->col = column;
     return tile;
 }
 
+Tile *TileCreateWithValue(uint32_t row, uint32_t column, uint32_t value) {
+    LOG_ASSERT_REASON(value > 1 && !(value & (value - 1)), ArgumentOutOfRangeReason);
+    uint8_t exponent = 0;
+    while (value > 1) {
+        value >>= 1;
+        exponent++;
+    }
+    return TileCreateWithExponent(row, column, exponent);
+}
+
+Tile *TileCreateWithExponent(uint32_t row, uint32_t column, uint8_t exponent) {
+    LOG_ASSERT_REASON(exponent, ArgumentOutOfRangeReason);
+    Tile *tile = TileCreate(row, column);
+    tile->exponent = exponent;
+    return tile;
+}
+
+Tile *TileCreateHandle(uint32_t row, uint32_t column, uint8_t *cell) {
+    LOG_ASSERT_REASON(cell, ArgumentNullReason);
+    Tile *tile = TileCreate(row, column);
+    tile->cell = cell;
+    return tile;
+}
+
 void TileDispose(Tile *tile) {
+    ChangeHandlerClear(&tile->valueChangedListeners, free);
     free(tile);
 }
 
@@ -48,11 +76,16 @@ uint32_t TileGetColumn(Tile *tile) {
     return tile->col;
 }
 
+uint8_t TileGetExponent(Tile *tile) {
+    return *tile->cell;
+}
+
 uint32_t TileGetValue(Tile *tile) {
-    return tile->val;
+    LOG_ASSERT_REASON(*tile->cell < 32, InvalidOperationReason);
+    return (uint32_t)1 << *tile->cell;
 }
 
-void TileAddValueChangeHandler(Tile *tile, TileChangeHandler handler, void *data) {
+ListenerHandle TileAddValueChangeHandler(Tile *tile, TileChangeHandler handler, void *data) {
     LOG_ASSERT_REASON(tile && handler, ArgumentNullReason);
     
     TileChangeData *d = calloc(1, sizeof(TileChangeData));
@@ -60,7 +93,7 @@ void TileAddValueChangeHandler(Tile *tile, TileChangeHandler handler, void *data
     d->clientData = data;
     
     ChangeData changeData = { .target = tile, .data = d, .handler = OnTileChanged };
-    ChangeHandlerAdd(&tile->valueChangedListeners, changeData);
+    return ChangeHandlerAdd(&tile->valueChangedListeners, changeData);
 }
 
 void TileRemoveValueChangeHandler(Tile *tile, TileChangeHandler handler) {
@@ -71,6 +104,21 @@ void TileRemoveValueChangeHandler(Tile *tile, TileChangeHandler handler) {
     free(d);
 }
 
+void TileRemoveValueChangeHandlerByHandle(Tile *tile, ListenerHandle handle) {
+    LOG_ASSERT_REASON(tile, ArgumentNullReason);
+    free(ChangeHandlerRemoveHandle(&tile->valueChangedListeners, handle));
+}
+
+void TileClearValueChangeHandlers(Tile *tile) {
+    LOG_ASSERT_REASON(tile, ArgumentNullReason);
+    ChangeHandlerClear(&tile->valueChangedListeners, free);
+}
+
+void TileNotifyValueChanged(Tile *tile) {
+    LOG_ASSERT_REASON(tile, ArgumentNullReason);
+    ChangeHandlerNotifyListeners(&tile->valueChangedListeners, 0);
+}
+
 int TileCanMerge(Tile *tile, Tile *toMerge) {
     LOG_ASSERT_REASON(tile && toMerge, ArgumentNullReason);
     
@@ -85,20 +133,17 @@ int TileCanMerge(Tile *tile, Tile *toMerge) {
         tile->row == toMerge->row + 1;
     
     return ((touchesX && hasSameY) || (hasSameX && touchesY))
-        && tile->val == toMerge->val;
+        && *tile->cell == *toMerge->cell;
 }
 
 void TileMerge(Tile *tile, Tile* toMerge) {
     LOG_ASSERT_REASON(tile && toMerge, ArgumentNullReason);
     LOG_ASSERT_REASON(TileCanMerge(tile, toMerge), InvalidOperationReason);
-    IncrementValue(tile, toMerge);
+    IncrementValue(tile);
 }
 
 Tile *TileCopyTo(Tile *tile, uint32_t row, uint32_t column) {
     Tile *t = TileCreate(row, column);
-    t->val = tile->val;
-    if (tile->valueChangedListeners) {
-        t->valueChangedListeners = tile->valueChangedListeners;//ListCopy(tile->valueChangedListeners);
-    }
+    t->exponent = *tile->cell;
     return t;
 }
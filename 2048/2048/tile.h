@@ -7,19 +7,35 @@
 
 #include <stdint.h>
 #include "cvidef.h"
+#include "change_notification.h"
+
+// Tiles hold the power of two they show, so a byte covers every value a board can reach. Merges
+// just bump the exponent.
+#define TILE_MAX_EXPONENT 255
 
 typedef struct Tile Tile;
 typedef void (*TileChangeHandler)(Tile *, void *data);
 
 Tile *TileCreate(uint32_t row, uint32_t column);
+Tile *TileCreateWithValue(uint32_t row, uint32_t column, uint32_t value);
+Tile *TileCreateWithExponent(uint32_t row, uint32_t column, uint8_t exponent);
+// Boards keep exponents in their own cell array and hand out handles onto it. A handle lives as
+// long as its board and reads whatever its cell holds, so it is only a tile while the cell is set.
+Tile *TileCreateHandle(uint32_t row, uint32_t column, uint8_t *cell);
 void TileDispose(Tile *tile);
 
 uint32_t TileGetRow(Tile *tile);
 uint32_t TileGetColumn(Tile *tile);
+uint8_t TileGetExponent(Tile *tile);
+// Only for tiles below 2^32; use the exponent for anything that may grow past that.
 uint32_t TileGetValue(Tile *tile);
 
-void TileAddValueChangeHandler(Tile *tile, TileChangeHandler handler, void *data);
+ListenerHandle TileAddValueChangeHandler(Tile *tile, TileChangeHandler handler, void *data);
 void TileRemoveValueChangeHandler(Tile *tile, TileChangeHandler handler);
+void TileRemoveValueChangeHandlerByHandle(Tile *tile, ListenerHandle handle);
+void TileClearValueChangeHandlers(Tile *tile);
+// For boards that merged into a handle's cell themselves.
+void TileNotifyValueChanged(Tile *tile);
 
 int TileCanMerge(Tile *target, Tile *toMerge);
 void TileMerge(Tile *target, Tile *toMerge);
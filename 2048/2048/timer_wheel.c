@@ -0,0 +1,250 @@
+#include <ansi_c.h>
+#include <toolbox.h>
+#include "timer_wheel.h"
+#include "../../CVI_Core/log.h"
+
+#define WHEEL_LEVELS 4
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+#define NO_TIMER UINT32_MAX
+// Absorbs rounding so that, e.g., 0.2s at 1ms ticks is 200 ticks rather than 199 or 201.
+#define TICK_EPSILON 1e-9
+
+typedef struct TimerNode {
+    uint32_t prev;
+    uint32_t next;
+    uint32_t *list;
+    uint32_t generation;
+    uint64_t expires;
+    TimerCallback callback;
+    void *data;
+} TimerNode;
+
+struct TimerWheel {
+    double tickSeconds;
+    uint64_t now;
+    double remainder;
+    TimerClock clock;
+    double clockOrigin;
+    uint64_t clockOriginTick;
+    TimerNode *nodes;
+    uint32_t numNodes;
+    uint32_t capacity;
+    uint32_t firstFree;
+    uint32_t pending;
+    uint32_t pendingLevel0;
+    uint32_t slots[WHEEL_LEVELS][WHEEL_SLOTS];
+};
+
+static void Link(TimerWheel *wheel, uint32_t idx, uint32_t *list) {
+    TimerNode *node = &wheel->nodes[idx];
+    node->list = list;
+    node->prev = NO_TIMER;
+    node->next = *list;
+    if (*list != NO_TIMER) {
+        wheel->nodes[*list].prev = idx;
+    }
+    *list = idx;
+}
+
+static void Unlink(TimerWheel *wheel, uint32_t idx) {
+    TimerNode *node = &wheel->nodes[idx];
+    if (node->prev != NO_TIMER) {
+        wheel->nodes[node->prev].next = node->next;
+    } else {
+        *node->list = node->next;
+    }
+    if (node->next != NO_TIMER) {
+        wheel->nodes[node->next].prev = node->prev;
+    }
+    if (node->list >= wheel->slots[0] && node->list < wheel->slots[0] + WHEEL_SLOTS) {
+        wheel->pendingLevel0--;
+    }
+    node->list = 0;
+}
+
+// Each level covers WHEEL_SLOTS times the span of the one below. Timers further out than the top
+// level can reach are parked in its furthest slot and re-filed as it comes around.
+static void Insert(TimerWheel *wheel, uint32_t idx) {
+    uint64_t expires = wheel->nodes[idx].expires;
+    uint64_t delta = expires - wheel->now;
+    for (int level = 0; level < WHEEL_LEVELS; level++) {
+        if (delta < ((uint64_t)1 << (WHEEL_BITS * (level + 1)))) {
+            uint32_t slot = (uint32_t)(expires >> (WHEEL_BITS * level)) & WHEEL_MASK;
+            Link(wheel, idx, &wheel->slots[level][slot]);
+            if (level == 0) {
+                wheel->pendingLevel0++;
+            }
+            return;
+        }
+    }
+    uint64_t furthest = wheel->now + ((uint64_t)1 << (WHEEL_BITS * WHEEL_LEVELS)) - 1;
+    uint32_t slot = (uint32_t)(furthest >> (WHEEL_BITS * (WHEEL_LEVELS - 1))) & WHEEL_MASK;
+    Link(wheel, idx, &wheel->slots[WHEEL_LEVELS - 1][slot]);
+}
+
+static void Release(TimerWheel *wheel, uint32_t idx) {
+    TimerNode *node = &wheel->nodes[idx];
+    // Zero is never handed out, so skip it if the counter wraps.
+    if (!++node->generation) {
+        ++node->generation;
+    }
+    node->callback = 0;
+    node->data = 0;
+    node->next = wheel->firstFree;
+    wheel->firstFree = idx;
+    wheel->pending--;
+}
+
+static uint32_t Allocate(TimerWheel *wheel) {
+    if (wheel->firstFree != NO_TIMER) {
+        uint32_t idx = wheel->firstFree;
+        wheel->firstFree = wheel->nodes[idx].next;
+        return idx;
+    }
+    if (wheel->numNodes == wheel->capacity) {
+        wheel->capacity = wheel->capacity ? wheel->capacity * 2 : 16;
+        wheel->nodes = realloc(wheel->nodes, wheel->capacity * sizeof(TimerNode));
+    }
+    uint32_t idx = wheel->numNodes++;
+    memset(&wheel->nodes[idx], 0, sizeof(TimerNode));
+    wheel->nodes[idx].generation = 1;
+    return idx;
+}
+
+static void Cascade(TimerWheel *wheel, int level) {
+    uint32_t slot = (uint32_t)(wheel->now >> (WHEEL_BITS * level)) & WHEEL_MASK;
+    uint32_t idx = wheel->slots[level][slot];
+    wheel->slots[level][slot] = NO_TIMER;
+    while (idx != NO_TIMER) {
+        uint32_t next = wheel->nodes[idx].next;
+        Insert(wheel, idx);
+        idx = next;
+    }
+}
+
+static void Tick(TimerWheel *wheel) {
+    wheel->now++;
+    for (int level = 1; level < WHEEL_LEVELS; level++) {
+        if ((wheel->now >> (WHEEL_BITS * (level - 1))) & WHEEL_MASK) {
+            break;
+        }
+        Cascade(wheel, level);
+    }
+
+    // Callbacks may schedule or cancel timers, so take the head each time rather than walking the list.
+    uint32_t *list = &wheel->slots[0][wheel->now & WHEEL_MASK];
+    while (*list != NO_TIMER) {
+        uint32_t idx = *list;
+        TimerCallback callback = wheel->nodes[idx].callback;
+        void *data = wheel->nodes[idx].data;
+        Unlink(wheel, idx);
+        Release(wheel, idx);
+        callback(data);
+    }
+}
+
+static void AdvanceTo(TimerWheel *wheel, uint64_t target) {
+    while (wheel->now < target) {
+        if (!wheel->pending) {
+            wheel->now = target;
+            return;
+        }
+        // Nothing can fire before the next cascade, so jump to just before it.
+        if (!wheel->pendingLevel0) {
+            uint64_t beforeCascade = wheel->now | WHEEL_MASK;
+            wheel->now = beforeCascade < target ? beforeCascade : target;
+            if (wheel->now == target) {
+                return;
+            }
+        }
+        Tick(wheel);
+    }
+}
+
+TimerWheel *TimerWheelCreate(double tickSeconds) {
+    LOG_ASSERT_REASON(tickSeconds > 0, ArgumentOutOfRangeReason);
+
+    TimerWheel *wheel = calloc(1, sizeof(TimerWheel));
+    wheel->tickSeconds = tickSeconds;
+    wheel->firstFree = NO_TIMER;
+    for (int level = 0; level < WHEEL_LEVELS; level++) {
+        for (int slot = 0; slot < WHEEL_SLOTS; slot++) {
+            wheel->slots[level][slot] = NO_TIMER;
+        }
+    }
+    return wheel;
+}
+
+void TimerWheelDispose(TimerWheel *wheel) {
+    LOG_ASSERT_REASON(wheel, ArgumentNullReason);
+    free(wheel->nodes);
+    free(wheel);
+}
+
+TimerHandle TimerWheelSchedule(TimerWheel *wheel, double delaySeconds, TimerCallback callback, void *data) {
+    LOG_ASSERT_REASON(wheel && callback, ArgumentNullReason);
+    LOG_ASSERT_REASON(delaySeconds >= 0, ArgumentOutOfRangeReason);
+
+    uint64_t ticks = (uint64_t)ceil(delaySeconds / wheel->tickSeconds - TICK_EPSILON);
+    uint32_t idx = Allocate(wheel);
+    TimerNode *node = &wheel->nodes[idx];
+    node->callback = callback;
+    node->data = data;
+    node->expires = wheel->now + (ticks ? ticks : 1);
+    wheel->pending++;
+    Insert(wheel, idx);
+
+    TimerHandle handle = { .slot = idx, .generation = node->generation };
+    return handle;
+}
+
+int TimerWheelCancel(TimerWheel *wheel, TimerHandle handle) {
+    LOG_ASSERT_REASON(wheel, ArgumentNullReason);
+    if (handle.slot >= wheel->numNodes) {
+        return 0;
+    }
+    TimerNode *node = &wheel->nodes[handle.slot];
+    if (node->generation != handle.generation || !node->callback) {
+        return 0;
+    }
+    Unlink(wheel, handle.slot);
+    Release(wheel, handle.slot);
+    return 1;
+}
+
+uint32_t TimerWheelPending(TimerWheel *wheel) {
+    LOG_ASSERT_REASON(wheel, ArgumentNullReason);
+    return wheel->pending;
+}
+
+double TimerWheelNow(TimerWheel *wheel) {
+    LOG_ASSERT_REASON(wheel, ArgumentNullReason);
+    return wheel->now * wheel->tickSeconds;
+}
+
+void TimerWheelAdvance(TimerWheel *wheel, double seconds) {
+    LOG_ASSERT_REASON(wheel, ArgumentNullReason);
+    LOG_ASSERT_REASON(seconds >= 0, ArgumentOutOfRangeReason);
+    // Carry what is left of a partial tick so many small steps add up.
+    wheel->remainder += seconds;
+    uint64_t ticks = (uint64_t)floor(wheel->remainder / wheel->tickSeconds + TICK_EPSILON);
+    wheel->remainder = Max(0.0, wheel->remainder - ticks * wheel->tickSeconds);
+    AdvanceTo(wheel, wheel->now + ticks);
+}
+
+void TimerWheelSetClock(TimerWheel *wheel, TimerClock clock) {
+    LOG_ASSERT_REASON(wheel, ArgumentNullReason);
+    wheel->clock = clock;
+    wheel->clockOrigin = clock ? clock() : 0;
+    wheel->clockOriginTick = wheel->now;
+}
+
+void TimerWheelPoll(TimerWheel *wheel) {
+    LOG_ASSERT_REASON(wheel && wheel->clock, ArgumentNullReason);
+    double elapsed = wheel->clock() - wheel->clockOrigin;
+    if (elapsed > 0) {
+        AdvanceTo(wheel, wheel->clockOriginTick + (uint64_t)floor(elapsed / wheel->tickSeconds + TICK_EPSILON));
+    }
+}
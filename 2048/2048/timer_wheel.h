@@ -0,0 +1,45 @@
+#ifndef __timer_wheel_H__
+#define __timer_wheel_H__
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+#include <stdint.h>
+#include "cvidef.h"
+
+// A hierarchical timer wheel: scheduling and cancelling are O(1) however many timers are pending.
+// Time only moves when the owner advances it, either by an explicit amount (a virtual clock for
+// headless runs and simulations) or by polling a real clock. Callbacks run on the thread that
+// advances the wheel.
+typedef struct TimerWheel TimerWheel;
+typedef void (*TimerCallback)(void *data);
+typedef double (*TimerClock)(void);
+
+typedef struct TimerHandle {
+    uint32_t slot;
+    uint32_t generation;
+} TimerHandle;
+
+TimerWheel *TimerWheelCreate(double tickSeconds);
+// Pending timers are dropped without being called.
+void TimerWheelDispose(TimerWheel *wheel);
+
+// Delays are rounded up to whole ticks, with a minimum of one tick.
+TimerHandle TimerWheelSchedule(TimerWheel *wheel, double delaySeconds, TimerCallback callback, void *data);
+// Returns 0 if the timer already fired or was cancelled.
+int TimerWheelCancel(TimerWheel *wheel, TimerHandle handle);
+uint32_t TimerWheelPending(TimerWheel *wheel);
+
+double TimerWheelNow(TimerWheel *wheel);
+void TimerWheelAdvance(TimerWheel *wheel, double seconds);
+// Clock time at the moment the clock is set becomes the wheel's current time. Polling advances the
+// wheel to wherever the clock has got to since; pass 0 to go back to advancing by hand.
+void TimerWheelSetClock(TimerWheel *wheel, TimerClock clock);
+void TimerWheelPoll(TimerWheel *wheel);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif  /* ndef __timer_wheel_H__ */
@@ -1,11 +1,36 @@
 #include <ansi_c.h>
 #include <userint.h>
 #include "toolbox.h"
+#include <utility.h>
 #include "../2048/game.h"
+#include "../2048/animator.h"
+#include "../2048/board_style.h"
 #include "../../CVI_Core/log.h"
 
-#define TILE_PADDING 6
 #define TILE_FONT "TileFont"
+#define TIMER_POLL_INTERVAL .01
+#define REDRAW_INTERVAL (1.0 / 30)
+#define NUM_FONT_BUCKETS 5
+#define ANIMATION_DURATION .1
+#define FRAME_INTERVAL (1.0 / 60)
+// A frame that takes longer than this to draw costs the frames after it rather than slowing the slide.
+#define FRAME_BUDGET (FRAME_INTERVAL / 2)
+
+static const int fontSizes[NUM_FONT_BUCKETS] = { 18, 24, 36, 48, 64 };
+
+typedef struct SpriteCache {
+    int canvas;
+    int height;
+    int width;
+    int bitmaps[TILE_MAX_EXPONENT + 1];
+} SpriteCache;
+
+typedef struct TileLayout {
+    int width;
+    int height;
+    Rect *tileRects;
+    Rect *textRects;
+} TileLayout;
 
 typedef struct Window {
     Controller *controller;
@@ -13,79 +38,117 @@ typedef struct Window {
     GameUpdateHandler *updateHandler;
     int boardPanel;
     int tileCanvas;
-    ListType tilesToUpdate;
+    int pollTimer;
+    int isUpdating;
+    uint32_t *dirtyCells;
+    int inputPosted;
+    TileLayout layout;
+    SpriteCache sprites;
+    int fontBucket;
+    int createdFonts;
+    char fontName[32];
+    int redrawPending;
+    TimerHandle redrawTimer;
+    Animator *animator;
+    int framePending;
+    TimerHandle frameTimer;
 } Window;
 
 static int OnPanelEvent(int panel, int event, void *ptr, int eventData1, int eventData2);
+static void InvalidateSprites(Window *window);
+
+// Tile and text rects only depend on the canvas size, so they are worked out once per size.
+static void UpdateLayout(Window *window, int height, int width) {
+    TileLayout *layout = &window->layout;
+    uint32_t numRows = GameBoardNumRows(window->gameBoard);
+    uint32_t numCols = GameBoardNumCols(window->gameBoard);
+    if (!layout->tileRects) {
+        layout->tileRects = calloc(numRows * numCols, sizeof(Rect));
+        layout->textRects = calloc(numRows * numCols, sizeof(Rect));
+    }
+    layout->height = height;
+    layout->width = width;
+
+    for (uint32_t row = 0; row < numRows; row++) {
+        for (uint32_t col = 0; col < numCols; col++) {
+            BoardStyleRect tile = BoardStyleTileRect(numRows, numCols, height, width, row, col);
+            BoardStyleRect text = BoardStyleTextRect(tile);
+            uint32_t idx = col + row * numCols;
+            layout->tileRects[idx] = MakeRect(tile.top, tile.left, tile.height, tile.width);
+            layout->textRects[idx] = MakeRect(text.top, text.left, text.height, text.width);
+        }
+    }
+}
 
-static Rect GetTileRect(int height, int width, uint32_t numRows, uint32_t numCols, uint32_t row, uint32_t col) {
-    int colMarginWidth = (numCols + 1) * TILE_PADDING;
-    int rowMarginWidth = (numRows + 1) * TILE_PADDING;
-    int tileWidth = (int)floor((width - colMarginWidth) / numCols);
-    int tileHeight = (int)floor((height - rowMarginWidth) / numRows);
-    int leftOverWidth = width - (tileWidth * numCols + colMarginWidth);
-    int leftOverHeight = height - (tileHeight * numRows + rowMarginWidth);
-    int topRowMarginExtra = (int)ceil(leftOverHeight / 2);
-    int leftColMarginExtra = (int)ceil(leftOverWidth / 2);
-    int top = tileHeight * row + (row + 1) * TILE_PADDING + topRowMarginExtra;
-    int left = tileWidth * col + (col + 1) * TILE_PADDING + leftColMarginExtra;
-
-    return MakeRect(top, left, tileHeight, tileWidth);
-}
-
-static int GetColorForTile(Tile *tile) {
-    if (!tile) {
-        return 0xCDC0B4;
-    }
-    uint32_t val = TileGetValue(tile);
-    switch(val) {
-        case 2: return 0xEEE4DA;
-        case 4: return 0xEDE0C8;
-        case 8: return 0xF2B179;
-        case 16: return 0xF59563;
-        case 32: return 0xF67C5F;
-        case 64: return 0xF65D3B;
-        case 128: return 0xEDCE71;
-        case 256: return 0xEDCC61;
-        case 512: return 0xECC850;
-        case 1024: return 0xEDC53F;
-        case 2048: return 0xEEC22E;
-    }
-    LOG_ASSERTMSG(0, "got unexpected value!");
-    return 0;
+static void InvalidateSprites(Window *window) {
+    SpriteCache *sprites = &window->sprites;
+    for (int i = 0; i <= TILE_MAX_EXPONENT; i++) {
+        if (sprites->bitmaps[i]) {
+            DiscardBitmap(sprites->bitmaps[i]);
+            sprites->bitmaps[i] = 0;
+        }
+    }
+    sprites->height = 0;
+    sprites->width = 0;
 }
 
-static void DrawTile(Window *window, uint32_t row, uint32_t col) {
+// Renders a tile once on the hidden sprite canvas and keeps the bitmap; after that every tile with
+// this value is a single blit until the tile size changes.
+static int GetTileSprite(Window *window, uint8_t exponent, Rect tileRect, Rect textRect) {
+    SpriteCache *sprites = &window->sprites;
+    if (sprites->height != tileRect.height || sprites->width != tileRect.width) {
+        InvalidateSprites(window);
+        sprites->height = tileRect.height;
+        sprites->width = tileRect.width;
+        SetCtrlAttribute(window->boardPanel, sprites->canvas, ATTR_HEIGHT, tileRect.height);
+        SetCtrlAttribute(window->boardPanel, sprites->canvas, ATTR_WIDTH, tileRect.width);
+    }
+
+    if (sprites->bitmaps[exponent]) {
+        return sprites->bitmaps[exponent];
+    }
+
     int p = window->boardPanel;
-    int c = window->tileCanvas;
+    int c = sprites->canvas;
+    Rect r = MakeRect(0, 0, tileRect.height, tileRect.width);
     CanvasStartBatchDraw(p, c);
-
-    int height, width;
-    uint32_t numRows, numCols;
-    numRows = GameBoardNumRows(window->gameBoard);
-    numCols = GameBoardNumCols(window->gameBoard);
-    GetCtrlAttribute(p, c, ATTR_WIDTH, &width);
-    GetCtrlAttribute(p, c, ATTR_HEIGHT, &height);
-    Rect r = GetTileRect(height, width, numRows, numCols, row, col);
-    CanvasClear(p, c, r);
-
-    Tile *tile = GameBoardGetTile(window->gameBoard, row, col);
-    int color = GetColorForTile(tile);
+    CanvasClear(p, c, VAL_ENTIRE_OBJECT);
+    int color = BoardStyleTileColor(exponent);
     SetCtrlAttribute(p, c, ATTR_PEN_COLOR, color);
     SetCtrlAttribute(p, c, ATTR_PEN_FILL_COLOR, color);
-    CanvasDrawRoundedRect(p, c, r, 6, 6, VAL_DRAW_FRAME_AND_INTERIOR);
+    CanvasDrawRoundedRect(p, c, r, BOARD_STYLE_CORNER_RADIUS, BOARD_STYLE_CORNER_RADIUS, VAL_DRAW_FRAME_AND_INTERIOR);
 
-    if (tile != 0) {
-        char numberText[64];
-        uint32_t val = TileGetValue(tile);
-        snprintf(numberText, sizeof(numberText), "%u", val);
-        color = val > 4 ? 0xF6F7FB : 0x756C65;
+    if (exponent != 0) {
+        color = BoardStyleTextColor(exponent);
         SetCtrlAttribute(p, c, ATTR_PEN_COLOR, color);
-        //SetCtrlAttribute(p, c, ATTR_PEN_FILL_COLOR, VAL_TRANSPARENT);
-        CanvasDrawText(p,c, numberText, TILE_FONT, r, VAL_CENTER);
+        Rect text = MakeRect(textRect.top - tileRect.top, textRect.left - tileRect.left, textRect.height, textRect.width);
+        CanvasDrawText(p, c, BoardStyleTileText(exponent), window->fontName, text, VAL_CENTER);
     }
-
     CanvasEndBatchDraw(p, c);
+
+    GetBitmapFromCanvas(p, c, r, &sprites->bitmaps[exponent]);
+    return sprites->bitmaps[exponent];
+}
+
+static Rect GetCanvasTileRect(Window *window, uint32_t row, uint32_t col) {
+    return window->layout.tileRects[col + row * GameBoardNumCols(window->gameBoard)];
+}
+
+static Rect GetCanvasTextRect(Window *window, uint32_t row, uint32_t col) {
+    return window->layout.textRects[col + row * GameBoardNumCols(window->gameBoard)];
+}
+
+// Draws over whatever is in the tile's rect; callers clear it first.
+static void DrawTileContents(Window *window, uint32_t row, uint32_t col) {
+    uint8_t exponent = GameBoardGetExponent(window->gameBoard, row, col);
+    Rect r = GetCanvasTileRect(window, row, col);
+    int sprite = GetTileSprite(window, exponent, r, GetCanvasTextRect(window, row, col));
+    CanvasDrawBitmap(window->boardPanel, window->tileCanvas, sprite, VAL_ENTIRE_OBJECT, r);
+}
+
+static void DrawTile(Window *window, uint32_t row, uint32_t col) {
+    CanvasClear(window->boardPanel, window->tileCanvas, GetCanvasTileRect(window, row, col));
+    DrawTileContents(window, row, col);
 }
 
 static void DrawAllTiles(Window *window) {
@@ -99,48 +162,309 @@ static void DrawAllTiles(Window *window) {
     CanvasClear(p, c, VAL_ENTIRE_OBJECT);
     for(int i = 0; i < rows; i++) {
         for(int j = 0; j < cols; j++) {
-            DrawTile(window, i, j);
+            DrawTileContents(window, i, j);
         }
     }
     int level = CanvasEndBatchDraw(p, c);
     LOG_ASSERTMSG(!level, "unmatched end batch draw!");
 }
 
-static void HandleBeginUpdateGame(void *target, GameBoard *gameBoard) {
-    Window *window = (Window *)target;
-    LOG_ASSERTMSG(!window->tilesToUpdate, "When we handle a begin update, our list should be NULL");
-    window->tilesToUpdate = ListCreate(sizeof(GameBoardCell));
-    CanvasStartBatchDraw(window->boardPanel, window->tileCanvas);
+static void UpdateTitle(Window *window) {
+    char title[64];
+    snprintf(title, sizeof(title), "2048 - Score: %llu", (unsigned long long)GameBoardGetScore(window->gameBoard));
+    SetPanelAttribute(window->boardPanel, ATTR_TITLE, title);
+}
+
+static int ToCanvasIndex(GameBoard *gameBoard, uint32_t row, uint32_t col) {
+    LOG_ASSERT_REASON(gameBoard, ArgumentNullReason);
+    uint32_t numRows = GameBoardNumRows(gameBoard);
+    uint32_t numCols = GameBoardNumCols(gameBoard);
+    LOG_ASSERT_REASON(row < numRows, ArgumentOutOfRangeReason);
+    LOG_ASSERT_REASON(col < numCols, ArgumentOutOfRangeReason);
+
+    uint32_t idx = col + row * numCols;
+    return idx;
+}
+
+static int IsCellDirty(Window *window, uint32_t idx) {
+    return (window->dirtyCells[idx / 32] >> (idx % 32)) & 1;
+}
+
+static void MarkCellDirty(Window *window, uint32_t idx) {
+    window->dirtyCells[idx / 32] |= (uint32_t)1 << (idx % 32);
+}
+
+static int IsRunDirty(Window *window, uint32_t row, uint32_t firstCol, uint32_t lastCol) {
+    for (uint32_t col = firstCol; col <= lastCol; col++) {
+        if (!IsCellDirty(window, ToCanvasIndex(window->gameBoard, row, col))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void ClearRunDirty(Window *window, uint32_t row, uint32_t firstCol, uint32_t lastCol) {
+    for (uint32_t col = firstCol; col <= lastCol; col++) {
+        uint32_t idx = ToCanvasIndex(window->gameBoard, row, col);
+        window->dirtyCells[idx / 32] &= ~((uint32_t)1 << (idx % 32));
+    }
+}
+
+// Walks the dirty cells in row-major order. Each run of dirty cells in a row is grown down over
+// following rows that are dirty across the same columns, the whole block is cleared in one go and
+// then each of its tiles is drawn once.
+static void DrawDirtyCells(Window *window) {
+    uint32_t rows = GameBoardNumRows(window->gameBoard);
+    uint32_t cols = GameBoardNumCols(window->gameBoard);
+    for (uint32_t row = 0; row < rows; row++) {
+        uint32_t col = 0;
+        while (col < cols) {
+            if (!IsCellDirty(window, ToCanvasIndex(window->gameBoard, row, col))) {
+                col++;
+                continue;
+            }
+            uint32_t firstCol = col;
+            while (col + 1 < cols && IsCellDirty(window, ToCanvasIndex(window->gameBoard, row, col + 1))) {
+                col++;
+            }
+            uint32_t lastCol = col;
+            uint32_t lastRow = row;
+            while (lastRow + 1 < rows && IsRunDirty(window, lastRow + 1, firstCol, lastCol)) {
+                lastRow++;
+            }
+
+            Rect topLeft = GetCanvasTileRect(window, row, firstCol);
+            Rect bottomRight = GetCanvasTileRect(window, lastRow, lastCol);
+            Rect block = MakeRect(topLeft.top, topLeft.left,
+                bottomRight.top + bottomRight.height - topLeft.top,
+                bottomRight.left + bottomRight.width - topLeft.left);
+            CanvasClear(window->boardPanel, window->tileCanvas, block);
+            for (uint32_t r = row; r <= lastRow; r++) {
+                for (uint32_t c = firstCol; c <= lastCol; c++) {
+                    DrawTileContents(window, r, c);
+                }
+                ClearRunDirty(window, r, firstCol, lastCol);
+            }
+            col = lastCol + 1;
+        }
+    }
+}
+
+static int GetFontBucket(int width) {
+    if (width < 300) { return 0; }
+    if (width < 410) { return 1; }
+    if (width < 550) { return 2; }
+    if (width < 650) { return 3; }
+    return 4;
+}
+
+// Each bucket's meta font is created the first time it is needed and kept for the life of the window.
+static void SelectFont(Window *window, int width) {
+    int bucket = GetFontBucket(width);
+    if (window->fontName[0] && bucket == window->fontBucket) {
+        return;
+    }
+    snprintf(window->fontName, sizeof(window->fontName), "%s%d", TILE_FONT, fontSizes[bucket]);
+    if (!(window->createdFonts & (1 << bucket))) {
+        CreateMetaFont(window->fontName, "Segoe UI", fontSizes[bucket], 1, 0, 0, 0);
+        window->createdFonts |= 1 << bucket;
+    }
+    window->fontBucket = bucket;
+    InvalidateSprites(window);
+}
+
+static void FlushRedraw(Window *window) {
+    if (window->redrawPending) {
+        window->redrawPending = 0;
+        TimerWheelCancel(ControllerGetTimers(window->controller), window->redrawTimer);
+        DrawAllTiles(window);
+    }
+}
+
+static void HandleRedrawTimer(void *data) {
+    FlushRedraw((Window *)data);
+}
+
+// Layout follows the drag straight away, but the board is redrawn at most once per frame.
+static void ScheduleRedraw(Window *window) {
+    if (!window->redrawPending) {
+        window->redrawPending = 1;
+        window->redrawTimer = TimerWheelSchedule(ControllerGetTimers(window->controller), REDRAW_INTERVAL, HandleRedrawTimer, window);
+    }
 }
 
-static int UpdateChangedTiles(int index, void *ptr, void *data) {
-    GameBoardCell *cell = (GameBoardCell *)ptr;
+static Rect GetCellRect(Window *window, uint32_t idx) {
+    return window->layout.tileRects[idx];
+}
+
+// Where a tile in flight sits this frame, shrunk about its centre while it grows in.
+static Rect GetAnimatedTileRect(Window *window, const AnimatedTile *tile) {
+    Rect from = GetCanvasTileRect(window, tile->from.row, tile->from.col);
+    Rect to = GetCanvasTileRect(window, tile->to.row, tile->to.col);
+    int top = from.top + (int)((to.top - from.top) * tile->progress);
+    int left = from.left + (int)((to.left - from.left) * tile->progress);
+    int height = (int)(to.height * tile->scale);
+    int width = (int)(to.width * tile->scale);
+    return MakeRect(top + (to.height - height) / 2, left + (to.width - width) / 2, height, width);
+}
+
+// The rect a tile sweeps between two cells, padding included.
+static Rect GetSpanRect(Window *window, GameBoardCell from, GameBoardCell to) {
+    Rect a = GetCanvasTileRect(window, from.row, from.col);
+    Rect b = GetCanvasTileRect(window, to.row, to.col);
+    int top = a.top < b.top ? a.top : b.top;
+    int left = a.left < b.left ? a.left : b.left;
+    return MakeRect(top, left, a.height + abs(a.top - b.top), a.width + abs(a.left - b.left));
+}
+
+// Clears everything the animation touches, lays the empty cells back down and then draws either
+// the tiles in flight or, once the animation is over, the board itself.
+static void DrawAnimationFrame(Window *window) {
+    int p = window->boardPanel;
+    int c = window->tileCanvas;
+    uint32_t numCols = GameBoardNumCols(window->gameBoard);
+    const AnimatedTile *tiles;
+    const uint32_t *cells;
+    uint32_t numTiles = AnimatorGetFrame(window->animator, Timer(), &tiles);
+    uint32_t numCells = AnimatorGetCells(window->animator, &cells);
+    int running = AnimatorIsRunning(window->animator);
+
+    CanvasStartBatchDraw(p, c);
+    for (uint32_t i = 0; i < numTiles; i++) {
+        CanvasClear(p, c, GetSpanRect(window, tiles[i].from, tiles[i].to));
+    }
+    for (uint32_t i = 0; i < numCells; i++) {
+        if (running) {
+            Rect r = GetCellRect(window, cells[i]);
+            int sprite = GetTileSprite(window, 0, r, window->layout.textRects[cells[i]]);
+            CanvasDrawBitmap(p, c, sprite, VAL_ENTIRE_OBJECT, r);
+        } else {
+            DrawTile(window, cells[i] / numCols, cells[i] % numCols);
+        }
+    }
+    for (uint32_t i = 0; running && i < numTiles; i++) {
+        const AnimatedTile *tile = &tiles[i];
+        Rect r = GetAnimatedTileRect(window, tile);
+        if (r.height > 0 && r.width > 0) {
+            int sprite = GetTileSprite(window, tile->exponent, GetCanvasTileRect(window, tile->to.row, tile->to.col),
+                GetCanvasTextRect(window, tile->to.row, tile->to.col));
+            CanvasDrawBitmap(p, c, sprite, VAL_ENTIRE_OBJECT, r);
+        }
+    }
+    int level = CanvasEndBatchDraw(p, c);
+    LOG_ASSERTMSG(!level, "unmatched end batch draw!");
+}
+
+static void ScheduleFrame(Window *window, double delay);
+
+static void HandleFrameTimer(void *data) {
     Window *window = (Window *)data;
-    DrawTile(window, cell->row, cell->col);
-    return 0;
+    window->framePending = 0;
+    double start = Timer();
+    DrawAnimationFrame(window);
+    if (AnimatorIsRunning(window->animator)) {
+        // Tiles are placed by the clock, so skipping frames only makes the slide coarser, never longer.
+        int dropped = (int)((Timer() - start) / FRAME_BUDGET);
+        ScheduleFrame(window, FRAME_INTERVAL * (1 + dropped));
+    }
+}
+
+static void ScheduleFrame(Window *window, double delay) {
+    window->framePending = 1;
+    window->frameTimer = TimerWheelSchedule(ControllerGetTimers(window->controller), delay, HandleFrameTimer, window);
+}
+
+static void QueueCellUpdate(Window *window, GameBoardCell cell);
+
+// Jumps a running animation straight to the board's current state.
+static void FinishAnimation(Window *window) {
+    if (window->framePending) {
+        window->framePending = 0;
+        TimerWheelCancel(ControllerGetTimers(window->controller), window->frameTimer);
+    }
+    if (!AnimatorIsRunning(window->animator)) {
+        return;
+    }
+    AnimatorFinish(window->animator);
+
+    uint32_t numCols = GameBoardNumCols(window->gameBoard);
+    const uint32_t *cells;
+    uint32_t numCells = AnimatorGetCells(window->animator, &cells);
+    if (!window->isUpdating) {
+        CanvasStartBatchDraw(window->boardPanel, window->tileCanvas);
+    }
+    for (uint32_t i = 0; i < numCells; i++) {
+        QueueCellUpdate(window, GameBoardMakeCell(cells[i] / numCols, cells[i] % numCols));
+    }
+    if (!window->isUpdating) {
+        CanvasEndBatchDraw(window->boardPanel, window->tileCanvas);
+    }
+}
+
+static void HandleBeginUpdateGame(void *target, GameBoard *gameBoard) {
+    Window *window = (Window *)target;
+    LOG_ASSERTMSG(!window->isUpdating, "Updates should not nest");
+    window->isUpdating = 1;
+    CanvasStartBatchDraw(window->boardPanel, window->tileCanvas);
 }
 
 static void HandleEndUpdateGame(void *target, GameBoard *gameBoard) {
     Window *window = (Window *)target;
 
-    ListApplyToEach(window->tilesToUpdate, 1, UpdateChangedTiles, window);
+    // A pending resize redraw repaints everything anyway.
+    if (window->redrawPending) {
+        uint32_t numCells = GameBoardNumRows(gameBoard) * GameBoardNumCols(gameBoard);
+        memset(window->dirtyCells, 0, (numCells + 31) / 32 * sizeof(uint32_t));
+    } else {
+        DrawDirtyCells(window);
+    }
 
     int level = CanvasEndBatchDraw(window->boardPanel, window->tileCanvas);
     LOG_ASSERTMSG(!level, "unmatched end batch draw!");
-    ListDispose(window->tilesToUpdate);
-    window->tilesToUpdate = 0;
+    window->isUpdating = 0;
+    FlushRedraw(window);
+    UpdateTitle(window);
 }
 
-static void HandleTileChange(void *target, Tile *tile) {
-    Window *window = (Window *)target;
-    GameBoardCell cell = GameBoardMakeCell(TileGetRow(tile), TileGetColumn(tile));
-    if (window->tilesToUpdate != 0) {
-        ListInsertItem(window->tilesToUpdate, &cell, END_OF_LIST);
+static void QueueCellUpdate(Window *window, GameBoardCell cell) {
+    if (window->isUpdating) {
+        MarkCellDirty(window, ToCanvasIndex(window->gameBoard, cell.row, cell.col));
     } else {
         DrawTile(window, cell.row, cell.col);
     }
 }
 
+static void HandleTileChange(void *target, Tile *tile) {
+    Window *window = (Window *)target;
+    QueueCellUpdate(window, GameBoardMakeCell(TileGetRow(tile), TileGetColumn(tile)));
+}
+
+// The diff's cells are left alone until the first frame, so the board keeps showing where the
+// tiles started from.
+static void HandleBoardDiff(void *target, GameBoard *gameBoard, const BoardDiff *diff) {
+    Window *window = (Window *)target;
+    FinishAnimation(window);
+    AnimatorStart(window->animator, diff, Timer());
+    if (AnimatorIsRunning(window->animator)) {
+        ScheduleFrame(window, 0);
+    }
+}
+
+static void HandleGameReset(void *target, GameBoard *gameBoard) {
+    Window *window = (Window *)target;
+    FinishAnimation(window);
+    if (!window->isUpdating) {
+        DrawAllTiles(window);
+        UpdateTitle(window);
+        return;
+    }
+
+    uint32_t numCells = GameBoardNumRows(gameBoard) * GameBoardNumCols(gameBoard);
+    for (uint32_t idx = 0; idx < numCells; idx++) {
+        MarkCellDirty(window, idx);
+    }
+}
+
 static GameUpdateHandler *MakeUpdateHandler(Window *window) {
     GameUpdateHandler *handler = calloc(1, sizeof(GameUpdateHandler));
 
@@ -150,21 +474,12 @@ static GameUpdateHandler *MakeUpdateHandler(Window *window) {
     handler->handleTileAdded = HandleTileChange;
     handler->handleTileRemoved = HandleTileChange;
     handler->handleTileValueChange = HandleTileChange;
+    handler->handleGameReset = HandleGameReset;
+    handler->handleBoardDiff = HandleBoardDiff;
 
     return handler;
 }
 
-static int ToCanvasIndex(GameBoard *gameBoard, uint32_t row, uint32_t col) {
-    LOG_ASSERT_REASON(gameBoard, ArgumentNullReason);
-    uint32_t numRows = GameBoardNumRows(gameBoard);
-    uint32_t numCols = GameBoardNumCols(gameBoard);
-    LOG_ASSERT_REASON(row < numRows, ArgumentOutOfRangeReason);
-    LOG_ASSERT_REASON(col < numCols, ArgumentOutOfRangeReason);
-
-    uint32_t idx = col + row * numCols;
-    return idx;
-}
-
 static Rect HandlePanelSizing(Window *window, int isUpDown, int eventData2) {
     Rect r;
     GetPanelEventRect(eventData2, &r);
@@ -182,39 +497,74 @@ static Rect HandlePanelSizing(Window *window, int isUpDown, int eventData2) {
     width = width < 200 ? 200 : width;
     if (isUpDown) { width = height; }
     else { height = width; }
-    SetCtrlAttribute(p, c, ATTR_HEIGHT, height);
-    SetCtrlAttribute(p, c, ATTR_WIDTH, width);
-    int size = 64;
-    if (width >= 650) { size = 64; }
-    else if (width < 300) { size = 18; }
-    else if (width < 410) { size = 24; }
-    else if (width < 550) { size = 36; }
-    else { size = 48; }
-    CreateMetaFont(TILE_FONT, "Segoe UI", size, 1, 0, 0, 0);
+    if (height != window->layout.height || width != window->layout.width) {
+        SetCtrlAttribute(p, c, ATTR_HEIGHT, height);
+        SetCtrlAttribute(p, c, ATTR_WIDTH, width);
+        UpdateLayout(window, height, width);
+        SelectFont(window, width);
+        ScheduleRedraw(window);
+    }
 
     height += titleBarThickness + frameHeight * 2;
     width += frameWidth * 2;
     r.width = width;
     r.height = height;
 
-    DrawAllTiles(window);
-
     return r;
 }
 
+static double ReadClock(void) {
+    return Timer();
+}
+
+static int CVICALLBACK OnPollTimer(int panel, int control, int event, void *callbackData, int eventData1, int eventData2) {
+    Window *window = (Window *)callbackData;
+    if (event == EVENT_TIMER_TICK) {
+        TimerWheelPoll(ControllerGetTimers(window->controller));
+    }
+    return 0;
+}
+
+static void CVICALLBACK ProcessQueuedInput(void *data) {
+    Window *window = (Window *)data;
+    window->inputPosted = 0;
+    ControllerProcessInput(window->controller);
+}
+
+static void QueueSlide(Window *window, SlideDirection direction) {
+    FinishAnimation(window);
+    if (ControllerPendingInput(window->controller) == CONTROLLER_INPUT_CAPACITY) {
+        ControllerProcessInput(window->controller);
+    }
+    ControllerQueueSlide(window->controller, direction);
+    // Keys that arrive before the deferred call runs are applied together, with a single redraw.
+    if (!window->inputPosted) {
+        window->inputPosted = 1;
+        PostDeferredCall(ProcessQueuedInput, window);
+    }
+}
+
 static void HandleKeyPress(Window *window, int key) {
     switch(key) {
         case VAL_UP_ARROW_VKEY:
-            ControllerHandleSlide(window->controller, SlideUp);
+            QueueSlide(window, SlideUp);
             break;
         case VAL_DOWN_ARROW_VKEY:
-            ControllerHandleSlide(window->controller, SlideDown);
+            QueueSlide(window, SlideDown);
             break;
         case VAL_LEFT_ARROW_VKEY:
-            ControllerHandleSlide(window->controller, SlideLeft);
+            QueueSlide(window, SlideLeft);
             break;
         case VAL_RIGHT_ARROW_VKEY:
-            ControllerHandleSlide(window->controller, SlideRight);
+            QueueSlide(window, SlideRight);
+            break;
+        case VAL_MENUKEY_MODIFIER | 'Z':
+            FinishAnimation(window);
+            ControllerUndo(window->controller);
+            break;
+        case VAL_MENUKEY_MODIFIER | 'Y':
+            FinishAnimation(window);
+            ControllerRedo(window->controller);
             break;
     }
 }
@@ -244,12 +594,25 @@ static Window *CreateWindow(Game2048 *game) {
     w->gameBoard = Game2048GameBoard(game);
     w->controller = Game2048Controller(game);
     w->updateHandler = MakeUpdateHandler(w);
+    uint32_t numCells = GameBoardNumRows(w->gameBoard) * GameBoardNumCols(w->gameBoard);
+    w->dirtyCells = calloc((numCells + 31) / 32, sizeof(uint32_t));
+    w->animator = AnimatorCreate(GameBoardNumRows(w->gameBoard), GameBoardNumCols(w->gameBoard), ANIMATION_DURATION);
     w->boardPanel = NewPanel(0, "2048", VAL_AUTO_CENTER, VAL_AUTO_CENTER, 500, 500);
     w->tileCanvas = NewCtrl(w->boardPanel, CTRL_CANVAS, 0, 0, 0);
+    w->sprites.canvas = NewCtrl(w->boardPanel, CTRL_CANVAS, 0, 0, 0);
+    SetCtrlAttribute(w->boardPanel, w->sprites.canvas, ATTR_VISIBLE, 0);
+    SetCtrlAttribute(w->boardPanel, w->sprites.canvas, ATTR_PICT_BGCOLOR, BOARD_STYLE_BACKGROUND);
+    SetCtrlAttribute(w->boardPanel, w->sprites.canvas, ATTR_ENABLE_ANTI_ALIASING, 1);
 
     ControllerSetGameUpdateHandler(w->controller, w->updateHandler);
+    ControllerSetCollapseInput(w->controller, 1);
+
+    w->pollTimer = NewCtrl(w->boardPanel, CTRL_TIMER, 0, 0, 0);
+    SetCtrlAttribute(w->boardPanel, w->pollTimer, ATTR_INTERVAL, TIMER_POLL_INTERVAL);
+    InstallCtrlCallback(w->boardPanel, w->pollTimer, OnPollTimer, w);
+    TimerWheelSetClock(ControllerGetTimers(w->controller), ReadClock);
 
-    SetPanelAttribute(w->boardPanel, ATTR_BACKCOLOR, 0xBBADA0);
+    SetPanelAttribute(w->boardPanel, ATTR_BACKCOLOR, BOARD_STYLE_BACKGROUND);
     SetPanelAttribute(w->boardPanel, ATTR_CONFORM_TO_SYSTEM_THEME, 1);
     SetPanelAttribute(w->boardPanel, ATTR_CALLBACK_FUNCTION_POINTER, OnPanelEvent);
     SetPanelAttribute(w->boardPanel, ATTR_CALLBACK_DATA, w);
@@ -259,16 +622,12 @@ static Window *CreateWindow(Game2048 *game) {
     GetPanelAttribute(w->boardPanel, ATTR_HEIGHT, &height);
     SetCtrlAttribute(w->boardPanel, w->tileCanvas, ATTR_WIDTH, width);
     SetCtrlAttribute(w->boardPanel, w->tileCanvas, ATTR_HEIGHT, height);
-    SetCtrlAttribute(w->boardPanel, w->tileCanvas, ATTR_PICT_BGCOLOR, 0xBBADA0);
+    UpdateLayout(w, height, width);
+    SetCtrlAttribute(w->boardPanel, w->tileCanvas, ATTR_PICT_BGCOLOR, BOARD_STYLE_BACKGROUND);
     SetCtrlAttribute(w->boardPanel, w->tileCanvas, ATTR_DRAW_POLICY, VAL_MARK_FOR_UPDATE);
     SetCtrlAttribute(w->boardPanel, w->tileCanvas, ATTR_ENABLE_ANTI_ALIASING, 1);
 
-    CreateMetaFont(TILE_FONT, "Segoe UI", 36, 1, 0, 0, 0);
-
-    GameBoardCell cell;
-    GameBoardTryGetOpenCell(w->gameBoard, &cell);
-
-    GameBoardAddTile(w->gameBoard, cell.row, cell.col);
+    SelectFont(w, width);
     DrawAllTiles(w);
 
     return w;
@@ -284,7 +643,19 @@ static void RunWindow(UserInterface *ui) {
 static void DisposeWindow(UserInterface *ui) {
     LOG_ASSERT_REASON(ui, ArgumentNullReason);
     Window *w = (Window *)ui->data;
-    ListDispose(w->tilesToUpdate);
+    // Detach first so no board update can schedule another frame once the pending ones are cancelled.
+    ControllerSetGameUpdateHandler(w->controller, 0);
+    if (w->redrawPending) {
+        TimerWheelCancel(ControllerGetTimers(w->controller), w->redrawTimer);
+    }
+    if (w->framePending) {
+        TimerWheelCancel(ControllerGetTimers(w->controller), w->frameTimer);
+    }
+    AnimatorDispose(w->animator);
+    free(w->dirtyCells);
+    InvalidateSprites(w);
+    free(w->layout.tileRects);
+    free(w->layout.textRects);
     DiscardPanel(w->boardPanel);
     free(w->updateHandler);
     w->updateHandler = 0;
@@ -0,0 +1,166 @@
+#include <ansi_c.h>
+#include "../../CVI_Test/CVI_Test.h"
+#include "../../2048/2048/animator.h"
+
+#define DURATION .1
+
+static Animator *animator;
+
+static BoardChange MakeChange(BoardChangeKind kind, int fromRow, int fromCol, int toRow, int toCol, uint8_t exponent);
+static BoardDiff MakeDiff(const BoardChange *changes, uint32_t numChanges);
+static int HasCell(uint32_t cell);
+
+/// REGION START Tests
+
+void TESTEXPORT MoveInterpolatesToTarget(TestContext *context) {
+    BoardChange changes[] = { MakeChange(BoardChangeMove, 0, 0, 0, 3, 1) };
+    BoardDiff diff = MakeDiff(changes, 1);
+    const AnimatedTile *tiles;
+
+    AnimatorStart(animator, &diff, 10);
+    ASSERT_INT_EQUAL(1, AnimatorGetFrame(animator, 10, &tiles), "wrong tile count!");
+    ASSERT_TRUE(tiles[0].progress == 0, "tile started away from its source!");
+    AnimatorGetFrame(animator, 10 + DURATION / 2, &tiles);
+    ASSERT_TRUE(tiles[0].progress > .5 && tiles[0].progress < 1, "tile not part way to its target!");
+    ASSERT_TRUE(AnimatorIsRunning(animator), "animation ended early!");
+    AnimatorGetFrame(animator, 10 + DURATION, &tiles);
+    ASSERT_TRUE(tiles[0].progress == 1, "tile did not reach its target!");
+    ASSERT_FALSE(AnimatorIsRunning(animator), "animation still running at the end!");
+}
+
+void TESTEXPORT LateFrameSkipsAhead(TestContext *context) {
+    BoardChange changes[] = { MakeChange(BoardChangeMove, 0, 0, 0, 3, 1) };
+    BoardDiff diff = MakeDiff(changes, 1);
+    const AnimatedTile *tiles;
+
+    AnimatorStart(animator, &diff, 0);
+    AnimatorGetFrame(animator, DURATION * 5, &tiles);
+
+    ASSERT_TRUE(tiles[0].progress == 1, "late frame did not land at the end!");
+    ASSERT_FALSE(AnimatorIsRunning(animator), "animation still running!");
+}
+
+void TESTEXPORT PathCoversEveryCellPassed(TestContext *context) {
+    BoardChange changes[] = { MakeChange(BoardChangeMove, 3, 1, 0, 1, 2) };
+    BoardDiff diff = MakeDiff(changes, 1);
+
+    AnimatorStart(animator, &diff, 0);
+
+    for (int row = 0; row < 4; row++) {
+        ASSERT_TRUE(HasCell(1 + row * 4), "cell on the path is missing!");
+    }
+    const uint32_t *cells;
+    ASSERT_INT_EQUAL(4, AnimatorGetCells(animator, &cells), "wrong number of cells!");
+}
+
+void TESTEXPORT MergeShowsOldValueUntilTheEnd(TestContext *context) {
+    // 2 2 . .  sliding left: the tile at (0,1) merges into the one at (0,0), which stays put.
+    BoardChange changes[] = { MakeChange(BoardChangeMerge, 0, 1, 0, 0, 2) };
+    BoardDiff diff = MakeDiff(changes, 1);
+    const AnimatedTile *tiles;
+
+    AnimatorStart(animator, &diff, 0);
+    uint32_t count = AnimatorGetFrame(animator, DURATION / 2, &tiles);
+
+    ASSERT_INT_EQUAL(2, count, "merge should draw both halves!");
+    ASSERT_INT_EQUAL(1, tiles[0].exponent, "consumed tile shows the merged exponent!");
+    ASSERT_TRUE(tiles[0].from.col == 1 && tiles[0].to.col == 0, "consumed tile moves the wrong way!");
+    ASSERT_INT_EQUAL(1, tiles[1].exponent, "stationary tile shows the merged exponent!");
+}
+
+void TESTEXPORT MovingMergeTargetIsNotDrawnTwice(TestContext *context) {
+    // . . 2 2  sliding left: both tiles travel, the second is consumed by the first.
+    BoardChange changes[] = {
+        MakeChange(BoardChangeMove, 0, 2, 0, 0, 2),
+        MakeChange(BoardChangeMerge, 0, 3, 0, 0, 2)
+    };
+    BoardDiff diff = MakeDiff(changes, 2);
+    const AnimatedTile *tiles;
+
+    AnimatorStart(animator, &diff, 0);
+    uint32_t count = AnimatorGetFrame(animator, 0, &tiles);
+
+    ASSERT_INT_EQUAL(2, count, "wrong tile count!");
+    ASSERT_INT_EQUAL(1, tiles[0].exponent, "wrong consumed exponent!");
+    ASSERT_INT_EQUAL(1, tiles[1].exponent, "wrong moving exponent!");
+}
+
+void TESTEXPORT AddedTileGrowsIn(TestContext *context) {
+    BoardChange changes[] = { MakeChange(BoardChangeAdd, 0, 0, 2, 2, 1) };
+    BoardDiff diff = MakeDiff(changes, 1);
+    const AnimatedTile *tiles;
+
+    AnimatorStart(animator, &diff, 0);
+    AnimatorGetFrame(animator, 0, &tiles);
+    ASSERT_TRUE(tiles[0].scale == 0, "added tile started full size!");
+    AnimatorGetFrame(animator, DURATION, &tiles);
+    ASSERT_TRUE(tiles[0].scale == 1, "added tile did not reach full size!");
+}
+
+void TESTEXPORT FinishStopsImmediately(TestContext *context) {
+    BoardChange changes[] = { MakeChange(BoardChangeMove, 0, 0, 0, 3, 1) };
+    BoardDiff diff = MakeDiff(changes, 1);
+
+    AnimatorStart(animator, &diff, 0);
+    AnimatorFinish(animator);
+
+    ASSERT_FALSE(AnimatorIsRunning(animator), "animation still running!");
+}
+
+void TESTEXPORT StartReplacesRunningAnimation(TestContext *context) {
+    BoardChange first[] = { MakeChange(BoardChangeMove, 0, 0, 0, 3, 1) };
+    BoardChange second[] = { MakeChange(BoardChangeMove, 3, 3, 3, 0, 1) };
+    BoardDiff diff = MakeDiff(first, 1);
+    const AnimatedTile *tiles;
+
+    AnimatorStart(animator, &diff, 0);
+    diff = MakeDiff(second, 1);
+    AnimatorStart(animator, &diff, DURATION / 2);
+
+    ASSERT_INT_EQUAL(1, AnimatorGetFrame(animator, DURATION / 2, &tiles), "old tiles survived!");
+    ASSERT_INT_EQUAL(3, tiles[0].from.row, "wrong tile animated!");
+    ASSERT_TRUE(tiles[0].progress == 0, "new animation did not restart the clock!");
+    ASSERT_FALSE(HasCell(0), "old cells survived!");
+}
+/// REGION END
+
+static BoardChange MakeChange(BoardChangeKind kind, int fromRow, int fromCol, int toRow, int toCol, uint8_t exponent) {
+    BoardChange change = { .kind = kind, .from = GameBoardMakeCell(fromRow, fromCol), .to = GameBoardMakeCell(toRow, toCol), .exponent = exponent };
+    return change;
+}
+
+static BoardDiff MakeDiff(const BoardChange *changes, uint32_t numChanges) {
+    BoardDiff diff = { .numChanges = numChanges, .changes = changes, .scoreDelta = 0 };
+    return diff;
+}
+
+static int HasCell(uint32_t cell) {
+    const uint32_t *cells;
+    uint32_t count = AnimatorGetCells(animator, &cells);
+    for (uint32_t i = 0; i < count; i++) {
+        if (cells[i] == cell) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void InitAnimatorTest(TestContext *context) {
+    animator = AnimatorCreate(4, 4, DURATION);
+}
+
+static void CleanupAnimatorTest(TestContext *context) {
+    AnimatorDispose(animator);
+    animator = 0;
+}
+
+BEGIN_MODULE_TEST(animator)
+    ADD_TEST(MoveInterpolatesToTarget, InitAnimatorTest, CleanupAnimatorTest)
+    ADD_TEST(LateFrameSkipsAhead, InitAnimatorTest, CleanupAnimatorTest)
+    ADD_TEST(PathCoversEveryCellPassed, InitAnimatorTest, CleanupAnimatorTest)
+    ADD_TEST(MergeShowsOldValueUntilTheEnd, InitAnimatorTest, CleanupAnimatorTest)
+    ADD_TEST(MovingMergeTargetIsNotDrawnTwice, InitAnimatorTest, CleanupAnimatorTest)
+    ADD_TEST(AddedTileGrowsIn, InitAnimatorTest, CleanupAnimatorTest)
+    ADD_TEST(FinishStopsImmediately, InitAnimatorTest, CleanupAnimatorTest)
+    ADD_TEST(StartReplacesRunningAnimation, InitAnimatorTest, CleanupAnimatorTest)
+END_MODULE_TEST
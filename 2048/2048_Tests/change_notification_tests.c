@@ -5,12 +5,16 @@
 static int wasNotified;
 static ListenerList listeners;
 static ChangeData changeData;
+static void *notifiedArgs;
+static void *notifiedData;
+
+static void HandleNotification(void *target, void *data, void *args);
 
 /// REGION START Tests
 
 void TESTEXPORT GetsSingleNotification(TestContext *context) {
     ChangeHandlerAdd(&listeners, changeData);
-    ChangeHandlerNotifyListeners(listeners);
+    ChangeHandlerNotifyListeners(&listeners, 0);
 
     ASSERT_TRUE(wasNotified, "No change notification!");
 }
@@ -18,7 +22,7 @@ void TESTEXPORT GetsSingleNotification(TestContext *context) {
 void TESTEXPORT RemovedGetsNoNotifications(TestContext *context) {
     ChangeHandlerAdd(&listeners, changeData);
     ChangeHandlerRemove(&listeners, changeData);
-    ChangeHandlerNotifyListeners(listeners);
+    ChangeHandlerNotifyListeners(&listeners, 0);
 
     ASSERT_FALSE(wasNotified, "Was notified!");
 }
@@ -26,7 +30,7 @@ void TESTEXPORT RemovedGetsNoNotifications(TestContext *context) {
 void TESTEXPORT GetsMultipleNotifications(TestContext *context) {
     ChangeHandlerAdd(&listeners, changeData);
     ChangeHandlerAdd(&listeners, changeData);
-    ChangeHandlerNotifyListeners(listeners);
+    ChangeHandlerNotifyListeners(&listeners, 0);
 
     ASSERT_INT_EQUAL(2, wasNotified, "Not notified twice!");
 }
@@ -35,7 +39,7 @@ void TESTEXPORT RemovedOnceGetsOneNotification(TestContext *context) {
     ChangeHandlerAdd(&listeners, changeData);
     ChangeHandlerAdd(&listeners, changeData);
     ChangeHandlerRemove(&listeners, changeData);
-    ChangeHandlerNotifyListeners(listeners);
+    ChangeHandlerNotifyListeners(&listeners, 0);
 
     ASSERT_INT_EQUAL(1, wasNotified, "Was not notified once!");
 }
@@ -46,25 +50,80 @@ void TESTEXPORT ClearedGetsNoNotifications(TestContext *context) {
     ChangeHandlerAdd(&listeners, changeData);
     ChangeHandlerClear(&listeners, 0);
 
-    ChangeHandlerNotifyListeners(listeners);
+    ChangeHandlerNotifyListeners(&listeners, 0);
     ASSERT_FALSE(wasNotified, "Was notified!");
 }
+
+void TESTEXPORT GrowsPastInlineStorage(TestContext *context) {
+    for (int i = 0; i < LISTENER_INLINE_CAPACITY * 3; i++) {
+        ChangeHandlerAdd(&listeners, changeData);
+    }
+    ChangeHandlerNotifyListeners(&listeners, 0);
+
+    ASSERT_INT_EQUAL(LISTENER_INLINE_CAPACITY * 3, wasNotified, "Not notified by every listener!");
+    ASSERT_INT_EQUAL(LISTENER_INLINE_CAPACITY * 3, ChangeHandlerCount(&listeners), "Wrong listener count!");
+}
+
+void TESTEXPORT RemoveMissingListenerReturnsNull(TestContext *context) {
+    ChangeData other = { .target = &other, .data = &other, .handler = HandleNotification };
+    ChangeHandlerAdd(&listeners, changeData);
+
+    ASSERT_IS_NULL(ChangeHandlerRemove(&listeners, other), "Removed a listener that was never added!");
+    ASSERT_INT_EQUAL(1, ChangeHandlerCount(&listeners), "Listener should still be registered!");
+}
+
+void TESTEXPORT GetsNotificationArgs(TestContext *context) {
+    int args = 42;
+    ChangeHandlerAdd(&listeners, changeData);
+    ChangeHandlerNotifyListeners(&listeners, &args);
+
+    ASSERT_PTR_EQUAL(&args, notifiedArgs, "Notification args were not passed through!");
+}
+
+void TESTEXPORT RemoveByHandleRemovesThatRegistration(TestContext *context) {
+    int first, second;
+    ChangeData data1 = { .target = 0, .data = &first, .handler = HandleNotification };
+    ChangeData data2 = { .target = 0, .data = &second, .handler = HandleNotification };
+    ListenerHandle handle1 = ChangeHandlerAdd(&listeners, data1);
+    ChangeHandlerAdd(&listeners, data2);
+
+    ASSERT_PTR_EQUAL(&first, ChangeHandlerRemoveHandle(&listeners, handle1), "Removed the wrong registration!");
+    ChangeHandlerNotifyListeners(&listeners, 0);
+
+    ASSERT_INT_EQUAL(1, wasNotified, "Was not notified once!");
+    ASSERT_PTR_EQUAL(&second, notifiedData, "Wrong registration is still listening!");
+}
+
+void TESTEXPORT RemoveByStaleHandleIsIgnored(TestContext *context) {
+    ListenerHandle handle = ChangeHandlerAdd(&listeners, changeData);
+    ChangeHandlerAdd(&listeners, changeData);
+    ChangeHandlerRemoveHandle(&listeners, handle);
+    // The freed slot is reused, so the stale handle now points at a live listener.
+    ChangeHandlerAdd(&listeners, changeData);
+
+    ASSERT_IS_NULL(ChangeHandlerRemoveHandle(&listeners, handle), "Removed by a stale handle!");
+    ASSERT_INT_EQUAL(2, ChangeHandlerCount(&listeners), "Stale handle removed a listener!");
+}
 /// REGION END
 
-static void HandleNotification(void *target, void *data) {
+static void HandleNotification(void *target, void *data, void *args) {
     wasNotified++;
+    notifiedArgs = args;
+    notifiedData = data;
 }
 
 static void InitNotificationTest(TestContext *context) {
-    listeners = 0;
+    memset(&listeners, 0, sizeof(listeners));
     wasNotified = 0;
+    notifiedArgs = 0;
+    notifiedData = 0;
     changeData.data = 0;
     changeData.target = 0;
     changeData.handler = HandleNotification;
 }
 
 static void CleanupNotificationTest(TestContext *context) {
-    ChangeHandlerRemove(&listeners, changeData);
+    ChangeHandlerClear(&listeners, 0);
     memset(&changeData, 0, sizeof(changeData));
 }
 
@@ -74,4 +133,9 @@ BEGIN_MODULE_TEST(change_notification)
     ADD_TEST(RemovedGetsNoNotifications, InitNotificationTest, CleanupNotificationTest)
     ADD_TEST(ClearedGetsNoNotifications, InitNotificationTest, CleanupNotificationTest)
     ADD_TEST(RemovedOnceGetsOneNotification, InitNotificationTest, CleanupNotificationTest)
+    ADD_TEST(GetsNotificationArgs, InitNotificationTest, CleanupNotificationTest)
+    ADD_TEST(GrowsPastInlineStorage, InitNotificationTest, CleanupNotificationTest)
+    ADD_TEST(RemoveMissingListenerReturnsNull, InitNotificationTest, CleanupNotificationTest)
+    ADD_TEST(RemoveByHandleRemovesThatRegistration, InitNotificationTest, CleanupNotificationTest)
+    ADD_TEST(RemoveByStaleHandleIsIgnored, InitNotificationTest, CleanupNotificationTest)
 END_MODULE_TEST
@@ -0,0 +1,156 @@
+#include <ansi_c.h>
+#include "../../CVI_Test/CVI_Test.h"
+#include "../../2048/2048/gameboard.h"
+#include "../../2048/2048/controller.h"
+#include "../../2048/2048/event_ring.h"
+
+static GameBoard *gameBoard;
+static Controller *controller;
+
+/// REGION START Tests
+
+void TESTEXPORT ControllerAppliesQueuedSlidesInOrder(TestContext *context) {
+    GameBoardAddTile(gameBoard, 0, 0);
+
+    ControllerQueueSlide(controller, SlideRight);
+    ControllerQueueSlide(controller, SlideLeft);
+    ControllerProcessInput(controller);
+
+    // Right first moves the tile and spawns one behind it; Left then merges the two.
+    ASSERT_INT_EQUAL(2, GameBoardGetExponent(gameBoard, 0, 0), "slides applied out of order!");
+    ASSERT_INT_EQUAL(0, ControllerPendingInput(controller), "queue should be empty!");
+}
+
+void TESTEXPORT ControllerCollapseKeepsSlideAfterSpawn(TestContext *context) {
+    GameBoardAddTile(gameBoard, 0, 3);
+    ControllerSetCollapseInput(controller, 1);
+
+    ControllerQueueSlide(controller, SlideLeft);
+    ControllerQueueSlide(controller, SlideLeft);
+    ControllerProcessInput(controller);
+
+    // The spawn after the first slide gives the second one something to do.
+    ASSERT_INT_EQUAL(2, GameBoardGetExponent(gameBoard, 0, 0), "second slide was dropped!");
+}
+
+void TESTEXPORT ControllerCollapseSkipsRepeatedSlideThatMovedNothing(TestContext *context) {
+    GameBoardAddTile(gameBoard, 0, 0);
+    ControllerSetCollapseInput(controller, 1);
+
+    ControllerQueueSlide(controller, SlideLeft);
+    ControllerQueueSlide(controller, SlideLeft);
+    ControllerQueueSlide(controller, SlideRight);
+    ControllerProcessInput(controller);
+
+    ASSERT_INT_EQUAL(1, GameBoardGetExponent(gameBoard, 0, 3), "slide after the skipped ones should apply!");
+    ASSERT_INT_EQUAL(0, ControllerPendingInput(controller), "queue should be empty!");
+}
+
+void TESTEXPORT ControllerQueueRejectsSlidesWhenFull(TestContext *context) {
+    for (int i = 0; i < CONTROLLER_INPUT_CAPACITY; i++) {
+        ASSERT_TRUE(ControllerQueueSlide(controller, SlideLeft), "slide should fit in the queue!");
+    }
+
+    ASSERT_FALSE(ControllerQueueSlide(controller, SlideRight), "full queue should reject the slide!");
+    ASSERT_INT_EQUAL(CONTROLLER_INPUT_CAPACITY, ControllerPendingInput(controller), "rejected slide was queued!");
+}
+
+void TESTEXPORT ControllerUndoRestoresBoardBeforeSlide(TestContext *context) {
+    GameBoardAddTile(gameBoard, 0, 0);
+    ControllerHandleSlide(controller, SlideRight);
+
+    ASSERT_TRUE(ControllerUndo(controller), "undo should succeed!");
+
+    ASSERT_INT_EQUAL(1, GameBoardGetExponent(gameBoard, 0, 0), "tile should be back where it started!");
+    ASSERT_INT_EQUAL(0, GameBoardGetExponent(gameBoard, 0, 3), "tile should have left the slid cell!");
+    ASSERT_FALSE(ControllerCanUndo(controller), "nothing left to undo!");
+    ASSERT_TRUE(ControllerCanRedo(controller), "should be able to redo!");
+
+    ASSERT_TRUE(ControllerRedo(controller), "redo should succeed!");
+    ASSERT_INT_EQUAL(1, GameBoardGetExponent(gameBoard, 0, 3), "redo should slide the tile again!");
+}
+
+void TESTEXPORT ControllerRedoKeepsPendingSpawn(TestContext *context) {
+    GameBoardAddTile(gameBoard, 0, 0);
+    ControllerHandleSlide(controller, SlideRight);
+
+    // Undo before the spawn timer fires; the spawn still belongs to the slide being undone.
+    ControllerUndo(controller);
+    ControllerRedo(controller);
+
+    ASSERT_INT_EQUAL(1, GameBoardGetExponent(gameBoard, 0, 3), "redo should slide the tile again!");
+    int numTiles = 0;
+    for (int col = 0; col < 4; col++) {
+        numTiles += GameBoardGetExponent(gameBoard, 0, col) != 0;
+    }
+    ASSERT_INT_EQUAL(2, numTiles, "redo should bring back the spawned tile!");
+}
+
+void TESTEXPORT ControllerMoveAfterUndoDropsRedo(TestContext *context) {
+    GameBoardAddTile(gameBoard, 0, 1);
+    ControllerHandleSlide(controller, SlideRight);
+    ControllerUndo(controller);
+
+    ControllerHandleSlide(controller, SlideLeft);
+
+    ASSERT_FALSE(ControllerCanRedo(controller), "a new move should drop redo!");
+    ASSERT_FALSE(ControllerRedo(controller), "redo should fail!");
+    ASSERT_INT_EQUAL(1, GameBoardGetExponent(gameBoard, 0, 0), "the new move should stand!");
+
+    ASSERT_TRUE(ControllerUndo(controller), "the new move should be undoable!");
+    ASSERT_INT_EQUAL(1, GameBoardGetExponent(gameBoard, 0, 1), "undo should go back to the start!");
+    ASSERT_FALSE(ControllerCanUndo(controller), "the undone move should be gone!");
+}
+
+void TESTEXPORT ControllerPublishesUpdatesToEventRing(TestContext *context) {
+    GameEventRing *ring = GameEventRingCreate(64);
+    GameEventCursor cursor = GameEventRingOpenCursor(ring);
+    GameBoardAddTile(gameBoard, 0, 0);
+    ControllerSetEventRing(controller, ring);
+
+    ControllerHandleSlide(controller, SlideRight);
+
+    GameEvent event;
+    int count = 0, sawAdd = 0;
+    GameEventKind first = -1, last = -1;
+    while (GameEventRingRead(ring, &cursor, &event, 0)) {
+        if (count++ == 0) {
+            first = event.kind;
+        }
+        last = event.kind;
+        sawAdd |= event.kind == GameEventTileAdded && event.to.col == 3 && event.exponent == 1;
+    }
+    ASSERT_INT_EQUAL(GameEventBeginUpdate, first, "update should open with a begin event!");
+    ASSERT_INT_EQUAL(GameEventEndUpdate, last, "update should close with an end event!");
+    ASSERT_TRUE(sawAdd, "slid tile should be published where it landed!");
+
+    ControllerSetEventRing(controller, 0);
+    ControllerHandleSlide(controller, SlideLeft);
+    ASSERT_FALSE(GameEventRingRead(ring, &cursor, &event, 0), "detached ring should get nothing!");
+    GameEventRingDispose(ring);
+}
+/// REGION END
+
+static void InitControllerTest(TestContext *context) {
+    gameBoard = GameBoardCreate(1, 4);
+    GameBoardSetSeed(gameBoard, 1);
+    controller = ControllerCreate(gameBoard);
+}
+
+static void CleanupControllerTest(TestContext *context) {
+    ControllerDispose(controller);
+    GameBoardDispose(gameBoard);
+    controller = 0;
+    gameBoard = 0;
+}
+
+BEGIN_MODULE_TEST(controller)
+    ADD_TEST(ControllerAppliesQueuedSlidesInOrder, InitControllerTest, CleanupControllerTest)
+    ADD_TEST(ControllerCollapseKeepsSlideAfterSpawn, InitControllerTest, CleanupControllerTest)
+    ADD_TEST(ControllerCollapseSkipsRepeatedSlideThatMovedNothing, InitControllerTest, CleanupControllerTest)
+    ADD_TEST(ControllerQueueRejectsSlidesWhenFull, InitControllerTest, CleanupControllerTest)
+    ADD_TEST(ControllerUndoRestoresBoardBeforeSlide, InitControllerTest, CleanupControllerTest)
+    ADD_TEST(ControllerRedoKeepsPendingSpawn, InitControllerTest, CleanupControllerTest)
+    ADD_TEST(ControllerMoveAfterUndoDropsRedo, InitControllerTest, CleanupControllerTest)
+    ADD_TEST(ControllerPublishesUpdatesToEventRing, InitControllerTest, CleanupControllerTest)
+END_MODULE_TEST
@@ -0,0 +1,82 @@
+#include <ansi_c.h>
+#include "../../CVI_Test/CVI_Test.h"
+#include "../../2048/2048/event_ring.h"
+
+static GameEventRing *ring;
+
+static void PublishValues(uint32_t first, uint32_t count);
+
+/// REGION START Tests
+
+void TESTEXPORT RingRoundsCapacityUp(TestContext *context) {
+    GameEventRing *r = GameEventRingCreate(5);
+    ASSERT_INT_EQUAL(8, GameEventRingCapacity(r), "capacity should round up to a power of two!");
+    GameEventRingDispose(r);
+}
+
+void TESTEXPORT RingReadsEventsInOrder(TestContext *context) {
+    GameEventCursor cursor = GameEventRingOpenCursor(ring);
+    PublishValues(1, 3);
+
+    GameEvent event;
+    uint32_t missed = 99;
+    for (uint32_t i = 1; i <= 3; i++) {
+        ASSERT_TRUE(GameEventRingRead(ring, &cursor, &event, &missed), "expected an event!");
+        ASSERT_INT_EQUAL(i, event.exponent, "events out of order!");
+        ASSERT_INT_EQUAL(0, missed, "no events should be missed!");
+    }
+    ASSERT_FALSE(GameEventRingRead(ring, &cursor, &event, &missed), "reader should be caught up!");
+}
+
+void TESTEXPORT RingCursorsAreIndependent(TestContext *context) {
+    GameEventCursor first = GameEventRingOpenCursor(ring);
+    PublishValues(1, 1);
+    GameEventCursor second = GameEventRingOpenCursor(ring);
+    PublishValues(2, 1);
+
+    GameEvent event;
+    ASSERT_TRUE(GameEventRingRead(ring, &first, &event, 0), "expected an event!");
+    ASSERT_INT_EQUAL(1, event.exponent, "first cursor should start at the first event!");
+    ASSERT_TRUE(GameEventRingRead(ring, &second, &event, 0), "expected an event!");
+    ASSERT_INT_EQUAL(2, event.exponent, "second cursor should only see later events!");
+}
+
+void TESTEXPORT RingReportsOverrun(TestContext *context) {
+    uint32_t capacity = GameEventRingCapacity(ring);
+    GameEventCursor cursor = GameEventRingOpenCursor(ring);
+    PublishValues(1, capacity + 3);
+
+    GameEvent event;
+    uint32_t missed = 0;
+    ASSERT_TRUE(GameEventRingRead(ring, &cursor, &event, &missed), "expected an event!");
+    ASSERT_INT_EQUAL(3, missed, "wrong number of missed events!");
+    ASSERT_INT_EQUAL(4, event.exponent, "should resume at the oldest event still in the ring!");
+
+    ASSERT_TRUE(GameEventRingRead(ring, &cursor, &event, &missed), "expected an event!");
+    ASSERT_INT_EQUAL(0, missed, "missed count should reset once caught up!");
+    ASSERT_INT_EQUAL(5, event.exponent, "events out of order after overrun!");
+}
+/// REGION END
+
+static void PublishValues(uint32_t first, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        GameEvent event = { .kind = GameEventTileAdded, .exponent = (uint8_t)(first + i) };
+        GameEventRingPublish(ring, &event);
+    }
+}
+
+static void InitRingTest(TestContext *context) {
+    ring = GameEventRingCreate(8);
+}
+
+static void CleanupRingTest(TestContext *context) {
+    GameEventRingDispose(ring);
+    ring = 0;
+}
+
+BEGIN_MODULE_TEST(event_ring)
+    ADD_TEST(RingRoundsCapacityUp, 0, 0)
+    ADD_TEST(RingReadsEventsInOrder, InitRingTest, CleanupRingTest)
+    ADD_TEST(RingCursorsAreIndependent, InitRingTest, CleanupRingTest)
+    ADD_TEST(RingReportsOverrun, InitRingTest, CleanupRingTest)
+END_MODULE_TEST
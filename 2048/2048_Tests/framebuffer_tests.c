@@ -0,0 +1,144 @@
+#include <ansi_c.h>
+#include "../../CVI_Test/CVI_Test.h"
+#include "../../2048/2048/framebuffer.h"
+#include "../../2048/2048/board_style.h"
+
+static GameBoard *gameBoard;
+static Controller *controller;
+static Framebuffer *framebuffer;
+
+static BoardStyleRect GetTileRect(uint32_t row, uint32_t col);
+static int GetTileColorAt(uint32_t row, uint32_t col);
+
+/// REGION START Tests
+
+void TESTEXPORT EmptyBoardDrawsEmptyCells(TestContext *context) {
+    FramebufferRender(framebuffer);
+
+    ASSERT_INT_EQUAL(BOARD_STYLE_BACKGROUND, FramebufferGetPixel(framebuffer, 0, 0), "wrong background!");
+    for (uint32_t row = 0; row < 4; row++) {
+        for (uint32_t col = 0; col < 4; col++) {
+            ASSERT_INT_EQUAL(BoardStyleTileColor(0), GetTileColorAt(row, col), "empty cell drawn wrong!");
+        }
+    }
+}
+
+void TESTEXPORT AddedTileIsDrawn(TestContext *context) {
+    GameBoardAddTile(gameBoard, 1, 2);
+
+    uint8_t exponent = TileGetExponent(GameBoardGetTile(gameBoard, 1, 2));
+    ASSERT_INT_EQUAL(BoardStyleTileColor(exponent), GetTileColorAt(1, 2), "added tile not drawn!");
+}
+
+void TESTEXPORT TileCornersAreRounded(TestContext *context) {
+    FramebufferRender(framebuffer);
+
+    BoardStyleRect r = GetTileRect(0, 0);
+    ASSERT_INT_EQUAL(BOARD_STYLE_BACKGROUND, FramebufferGetPixel(framebuffer, r.top, r.left), "corner not rounded!");
+    ASSERT_INT_EQUAL(BoardStyleTileColor(0), FramebufferGetPixel(framebuffer, r.top, r.left + r.width / 2), "edge missing!");
+}
+
+void TESTEXPORT TileTextIsDrawn(TestContext *context) {
+    GameBoardAddTile(gameBoard, 0, 0);
+
+    uint8_t exponent = TileGetExponent(GameBoardGetTile(gameBoard, 0, 0));
+    BoardStyleRect r = GetTileRect(0, 0);
+    int textPixels = 0;
+    for (int y = r.top; y < r.top + r.height; y++) {
+        for (int x = r.left; x < r.left + r.width; x++) {
+            textPixels += FramebufferGetPixel(framebuffer, y, x) == BoardStyleTextColor(exponent);
+        }
+    }
+    ASSERT_TRUE(textPixels > 0, "no text drawn!");
+}
+
+void TESTEXPORT SlideIsOneFrame(TestContext *context) {
+    GameBoardAddTile(gameBoard, 0, 3);
+    uint32_t frames = FramebufferFrameCount(framebuffer);
+
+    ControllerHandleSlide(controller, SlideLeft);
+
+    ASSERT_INT_EQUAL(frames + 1, FramebufferFrameCount(framebuffer), "slide was not one frame!");
+    ASSERT_INT_EQUAL(BoardStyleTileColor(0), GetTileColorAt(0, 3), "old cell not cleared!");
+    ASSERT_INT_EQUAL(BoardStyleTileColor(TileGetExponent(GameBoardGetTile(gameBoard, 0, 0))), GetTileColorAt(0, 0), "moved tile not drawn!");
+    ASSERT_TRUE(FramebufferLastRenderTime(framebuffer) >= 0, "negative render time!");
+    ASSERT_TRUE(FramebufferTotalRenderTime(framebuffer) >= FramebufferLastRenderTime(framebuffer), "render time not accumulated!");
+}
+
+void TESTEXPORT ResizeRedrawsAtNewSize(TestContext *context) {
+    GameBoardAddTile(gameBoard, 3, 3);
+    FramebufferResize(framebuffer, 200, 300);
+    FramebufferRender(framebuffer);
+
+    int height, width;
+    FramebufferPixels(framebuffer, &height, &width);
+    ASSERT_INT_EQUAL(200, height, "wrong height!");
+    ASSERT_INT_EQUAL(300, width, "wrong width!");
+    uint8_t exponent = TileGetExponent(GameBoardGetTile(gameBoard, 3, 3));
+    ASSERT_INT_EQUAL(BoardStyleTileColor(exponent), GetTileColorAt(3, 3), "tile not drawn at new size!");
+}
+
+void TESTEXPORT WritesPpm(TestContext *context) {
+    FramebufferResize(framebuffer, 20, 30);
+    FramebufferRender(framebuffer);
+    FILE *file = tmpfile();
+
+    ASSERT_TRUE(FramebufferWritePpm(framebuffer, file), "write failed!");
+    long size = ftell(file);
+    rewind(file);
+    char header[16] = { 0 };
+    fread(header, 1, 12, file);
+    fclose(file);
+
+    ASSERT_TRUE(!strcmp("P6\n30 20\n255", header), "wrong header!");
+    ASSERT_INT_EQUAL(13 + 20 * 30 * 3, size, "wrong file size!");
+}
+
+void TESTEXPORT DisposeDetachesFromController(TestContext *context) {
+    Framebuffer *other = FramebufferCreate(gameBoard, controller, FRAMEBUFFER_DEFAULT_SIZE, FRAMEBUFFER_DEFAULT_SIZE);
+    FramebufferDispose(other);
+    GameBoardAddTile(gameBoard, 0, 0);
+
+    ControllerHandleSlide(controller, SlideRight);
+
+    ASSERT_NOT_NULL(GameBoardGetTile(gameBoard, 0, 3), "controller should carry on without a framebuffer!");
+}
+/// REGION END
+
+static BoardStyleRect GetTileRect(uint32_t row, uint32_t col) {
+    int height, width;
+    FramebufferPixels(framebuffer, &height, &width);
+    return BoardStyleTileRect(4, 4, height, width, row, col);
+}
+
+// Samples between the tile's top edge and its text.
+static int GetTileColorAt(uint32_t row, uint32_t col) {
+    BoardStyleRect r = GetTileRect(row, col);
+    return FramebufferGetPixel(framebuffer, r.top + r.height / 8, r.left + r.width / 2);
+}
+
+static void InitFramebufferTest(TestContext *context) {
+    gameBoard = GameBoardCreate(4, 4);
+    controller = ControllerCreate(gameBoard);
+    framebuffer = FramebufferCreate(gameBoard, controller, FRAMEBUFFER_DEFAULT_SIZE, FRAMEBUFFER_DEFAULT_SIZE);
+}
+
+static void CleanupFramebufferTest(TestContext *context) {
+    FramebufferDispose(framebuffer);
+    ControllerDispose(controller);
+    GameBoardDispose(gameBoard);
+    controller = 0;
+    gameBoard = 0;
+    framebuffer = 0;
+}
+
+BEGIN_MODULE_TEST(framebuffer)
+    ADD_TEST(EmptyBoardDrawsEmptyCells, InitFramebufferTest, CleanupFramebufferTest)
+    ADD_TEST(AddedTileIsDrawn, InitFramebufferTest, CleanupFramebufferTest)
+    ADD_TEST(TileCornersAreRounded, InitFramebufferTest, CleanupFramebufferTest)
+    ADD_TEST(TileTextIsDrawn, InitFramebufferTest, CleanupFramebufferTest)
+    ADD_TEST(SlideIsOneFrame, InitFramebufferTest, CleanupFramebufferTest)
+    ADD_TEST(ResizeRedrawsAtNewSize, InitFramebufferTest, CleanupFramebufferTest)
+    ADD_TEST(WritesPpm, InitFramebufferTest, CleanupFramebufferTest)
+    ADD_TEST(DisposeDetachesFromController, InitFramebufferTest, CleanupFramebufferTest)
+END_MODULE_TEST
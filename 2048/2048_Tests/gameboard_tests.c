@@ -1,5 +1,6 @@
 #include <toolbox.h>
 #include <ansi_c.h>
+#include <utility.h>
 #include "../../CVI_Core/log.h"
 #include "../../CVI_Test/CVI_Test.h"
 #include "../../2048/2048/gameboard.h"
@@ -12,6 +13,10 @@ static int tileAddCount;
 static int tileRemoveCount;
 static Tile *tileAdded;
 static Tile *tileRemoved;
+static int tileResetCount;
+static int diffCount;
+static BoardDiff lastDiff;
+static BoardChange lastChanges[16];
 
 static void TestHandleAddRemoveTile(Tile *tile, AddRemoveReason reason, void *data) {
     int *countPtr = (int *)data;
@@ -19,12 +24,57 @@ static void TestHandleAddRemoveTile(Tile *tile, AddRemoveReason reason, void *da
         tileAdded = tile;
     } else if (reason == Removed) {
         tileRemoved = tile;
+    } else if (reason == Reset) {
+        tileResetCount++;
     } else {
         LOG_ASSERTMSG(0, "invalid add remove reason");
     }
     (*countPtr)++;
 }
 
+static void TestHandleDiff(GameBoard *board, const BoardDiff *diff, void *data) {
+    diffCount++;
+    lastDiff = *diff;
+    memcpy(lastChanges, diff->changes, diff->numChanges * sizeof(BoardChange));
+    lastDiff.changes = lastChanges;
+}
+
+static void TestHandleReset(GameBoard *board, void *data) {
+    (*(int *)data)++;
+}
+
+static int CVICALLBACK SubscribeFromOtherThread(void *data) {
+    GameBoardAddTileAddRemoveHandler(gameBoard, &tileAddCount, TestHandleAddRemoveTile);
+    return 0;
+}
+
+static void TestSubscribeDuringSlide(Tile *tile, void *data) {
+    CmtThreadFunctionID id;
+    CmtScheduleThreadPoolFunction(DEFAULT_THREAD_POOL_HANDLE, SubscribeFromOtherThread, 0, &id);
+    CmtWaitForThreadPoolFunctionCompletion(DEFAULT_THREAD_POOL_HANDLE, id, 0);
+    CmtReleaseThreadPoolFunctionID(DEFAULT_THREAD_POOL_HANDLE, id);
+}
+
+static void TestCountValueChange(Tile *tile, void *data) {
+    (*(int *)data)++;
+}
+
+static const BoardChange *FindChange(BoardChangeKind kind) {
+    for (uint32_t i = 0; i < lastDiff.numChanges; i++) {
+        if (lastChanges[i].kind == kind) {
+            return &lastChanges[i];
+        }
+    }
+    return 0;
+}
+
+static void TestHandleAddToOtherBoard(Tile *tile, AddRemoveReason reason, void *data) {
+    GameBoard *other = (GameBoard *)data;
+    if (reason == Added && GameBoardCanAddTile(other, 0, 0)) {
+        GameBoardAddTile(other, 0, 0);
+    }
+}
+
 /// REGION START Tests
 void TESTEXPORT GameBoardGetRows(TestContext *context) {
     ASSERT_INT_EQUAL(NUM_ROWS, GameBoardNumRows(gameBoard), "should have 1 row!");
@@ -83,6 +133,23 @@ void TESTEXPORT GameBoardTestAddTile(TestContext *context) {
     ASSERT_FALSE(GameBoardGetTile(gameBoard, 0, 1), "Should not have tile at 0,1");
 }
 
+void TESTEXPORT GameBoardGetExponentReadsCell(TestContext *context) {
+    GameBoardAddTile(gameBoard, 0, 1);
+    ASSERT_INT_EQUAL(0, GameBoardGetExponent(gameBoard, 0, 0), "empty cell should read 0");
+    ASSERT_INT_EQUAL(1, GameBoardGetExponent(gameBoard, 0, 1), "new tile should read 1");
+}
+
+void TESTEXPORT GameBoardTileHandleStaysWithCell(TestContext *context) {
+    GameBoardAddTile(gameBoard, 0, 0);
+    Tile *handle = GameBoardGetTile(gameBoard, 0, 0);
+    GameBoardAddTile(gameBoard, 0, 1);
+    GameBoardTrySlide(gameBoard, SlideLeft);
+
+    ASSERT_PTR_EQUAL(handle, GameBoardGetTile(gameBoard, 0, 0), "cell should keep its handle");
+    ASSERT_INT_EQUAL(2, TileGetExponent(handle), "handle should read the merged value");
+    ASSERT_INT_EQUAL(0, TileGetRow(handle), "handle should keep its cell");
+}
+
 void TESTEXPORT GameBoardAddTileNotifies(TestContext *context) {
     GameBoardAddTileAddRemoveHandler(gameBoard, &tileAddCount, TestHandleAddRemoveTile);
     GameBoardAddTile(gameBoard, 0, 0);
@@ -535,6 +602,372 @@ void TESTEXPORT GameBoard_SlideTiles_Down6(TestContext * context) {
     ASSERT_INT_EQUAL(2, TileGetValue(GameBoardGetTile(gameBoard, 1, 1)), "tile should have original value");
     ASSERT_INT_EQUAL(2, TileGetValue(GameBoardGetTile(gameBoard, 1, 0)), "tile should have original value");
 }
+
+void TESTEXPORT GameBoard_Snapshot_RoundTrip(TestContext *context) {
+    gameBoard = GameBoardCreate(2, 3);
+    GameBoardAddTile(gameBoard, 0, 0);
+    GameBoardAddTile(gameBoard, 0, 1);
+    GameBoardAddTile(gameBoard, 1, 2);
+    GameBoardTrySlide(gameBoard, SlideLeft);
+
+    char buffer[64];
+    size_t size = GameBoardSaveSnapshot(gameBoard, buffer, sizeof(buffer));
+    ASSERT_INT_EQUAL(GameBoardSnapshotSize(gameBoard), size, "should have written the whole snapshot");
+
+    GameBoard *restored = GameBoardCreateFromSnapshot(buffer, size);
+    ASSERT_NOT_NULL(restored, "should restore a valid snapshot");
+    ASSERT_INT_EQUAL(2, GameBoardNumRows(restored), "should restore the row count");
+    ASSERT_INT_EQUAL(3, GameBoardNumCols(restored), "should restore the col count");
+    ASSERT_INT_EQUAL(4, TileGetValue(GameBoardGetTile(restored, 0, 0)), "should restore merged value");
+    ASSERT_INT_EQUAL(2, TileGetValue(GameBoardGetTile(restored, 1, 0)), "should restore slid value");
+    ASSERT_IS_NULL(GameBoardGetTile(restored, 0, 1), "should restore empty cells");
+    ASSERT_IS_NULL(GameBoardGetTile(restored, 1, 2), "should restore empty cells");
+    GameBoardDispose(restored);
+}
+
+void TESTEXPORT GameBoard_Snapshot_RestoresRandomState(TestContext *context) {
+    gameBoard = GameBoardCreate(4, 4);
+    char buffer[64];
+    size_t size = GameBoardSaveSnapshot(gameBoard, buffer, sizeof(buffer));
+
+    GameBoardCell first, second;
+    GameBoardTryGetOpenCell(gameBoard, &first);
+    GameBoardRestoreSnapshot(gameBoard, buffer, size, RestoreNotifyPerTile);
+    GameBoardTryGetOpenCell(gameBoard, &second);
+
+    ASSERT_INT_EQUAL(first.row, second.row, "should pick the same open cell after restoring");
+    ASSERT_INT_EQUAL(first.col, second.col, "should pick the same open cell after restoring");
+}
+
+void TESTEXPORT GameBoard_Snapshot_RejectsBadSnapshot(TestContext *context) {
+    char buffer[64] = { 0 };
+    ASSERT_IS_NULL(GameBoardCreateFromSnapshot(buffer, sizeof(buffer)), "should reject a snapshot with no header");
+
+    gameBoard = GameBoardCreate(1, 2);
+    GameBoard *other = GameBoardCreate(2, 2);
+    size_t size = GameBoardSaveSnapshot(other, buffer, sizeof(buffer));
+    ASSERT_FALSE(GameBoardRestoreSnapshot(gameBoard, buffer, size, RestoreNotifyPerTile), "should reject a different board size");
+    ASSERT_FALSE(GameBoardSaveSnapshot(other, buffer, 4), "should not write into a short buffer");
+    GameBoardDispose(other);
+}
+
+void TESTEXPORT GameBoard_Snapshot_RejectsOversizedDimensions(TestContext *context) {
+    char buffer[64] = { 0 };
+    gameBoard = GameBoardCreate(2, 2);
+    size_t size = GameBoardSaveSnapshot(gameBoard, buffer, sizeof(buffer));
+    GameBoardSnapshotHeader *header = (GameBoardSnapshotHeader *)buffer;
+
+    // Rows times columns wraps to zero in 32 bits.
+    header->numRows = 0x10000;
+    header->numCols = 0x10000;
+    ASSERT_IS_NULL(GameBoardCreateFromSnapshot(buffer, size), "should reject a board too large to size");
+
+    header->numRows = UINT32_MAX;
+    header->numCols = 1;
+    ASSERT_IS_NULL(GameBoardCreateFromSnapshot(buffer, size), "should reject a dimension over the cap");
+}
+
+void TESTEXPORT GameBoard_Snapshot_RestoreNotifiesPerTile(TestContext *context) {
+    gameBoard = GameBoardCreate(1, 2);
+    char buffer[64];
+    GameBoardAddTile(gameBoard, 0, 0);
+    GameBoardAddTile(gameBoard, 0, 1);
+    size_t size = GameBoardSaveSnapshot(gameBoard, buffer, sizeof(buffer));
+    GameBoardTrySlide(gameBoard, SlideLeft);
+
+    GameBoardAddTileAddRemoveHandler(gameBoard, &tileAddCount, TestHandleAddRemoveTile);
+    GameBoardRestoreSnapshot(gameBoard, buffer, size, RestoreNotifyPerTile);
+
+    ASSERT_INT_EQUAL(3, tileAddCount, "should remove the merged tile and add both originals");
+    ASSERT_INT_EQUAL(0, tileResetCount, "should not send a reset");
+    ASSERT_INT_EQUAL(2, TileGetValue(GameBoardGetTile(gameBoard, 0, 0)), "should restore original value");
+    ASSERT_INT_EQUAL(2, TileGetValue(GameBoardGetTile(gameBoard, 0, 1)), "should restore original value");
+}
+
+void TESTEXPORT GameBoard_Snapshot_RestoreSendsDiff(TestContext *context) {
+    gameBoard = GameBoardCreate(1, 2);
+    char buffer[64];
+    GameBoardAddTile(gameBoard, 0, 0);
+    GameBoardAddTile(gameBoard, 0, 1);
+    size_t size = GameBoardSaveSnapshot(gameBoard, buffer, sizeof(buffer));
+    GameBoardTrySlide(gameBoard, SlideLeft);
+
+    GameBoardAddDiffHandler(gameBoard, 0, TestHandleDiff);
+    GameBoardRestoreSnapshot(gameBoard, buffer, size, RestoreNotifyPerTile);
+
+    ASSERT_INT_EQUAL(1, diffCount, "should send a single diff");
+    ASSERT_INT_EQUAL(3, lastDiff.numChanges, "should remove the merged tile and add both originals");
+    const BoardChange *remove = FindChange(BoardChangeRemove);
+    ASSERT_NOT_NULL((void *)remove, "should have a remove");
+    ASSERT_INT_EQUAL(0, remove->from.col, "should remove the merged tile");
+    ASSERT_INT_EQUAL(2, remove->exponent, "should report the exponent that was removed");
+}
+
+void TESTEXPORT GameBoard_Snapshot_RestoreNotifiesReset(TestContext *context) {
+    gameBoard = GameBoardCreate(1, 2);
+    char buffer[64];
+    GameBoardAddTile(gameBoard, 0, 0);
+    GameBoardAddTile(gameBoard, 0, 1);
+    size_t size = GameBoardSaveSnapshot(gameBoard, buffer, sizeof(buffer));
+    GameBoardTrySlide(gameBoard, SlideLeft);
+
+    GameBoardAddTileAddRemoveHandler(gameBoard, &tileAddCount, TestHandleAddRemoveTile);
+    GameBoardRestoreSnapshot(gameBoard, buffer, size, RestoreNotifyReset);
+
+    ASSERT_INT_EQUAL(1, tileAddCount, "should send a single notification");
+    ASSERT_INT_EQUAL(1, tileResetCount, "should send a reset");
+    ASSERT_NOT_NULL(GameBoardGetTile(gameBoard, 0, 1), "should restore the second tile");
+}
+
+void TESTEXPORT GameBoardLinesRunInSlideOrder(TestContext *context) {
+    gameBoard = GameBoardCreate(2, 3);
+    GameBoardAddTile(gameBoard, 1, 2);
+
+    ASSERT_INT_EQUAL(3, GameBoardNumLines(gameBoard, SlideUp), "a vertical slide has a line per column");
+    ASSERT_INT_EQUAL(2, GameBoardNumLines(gameBoard, SlideLeft), "a horizontal slide has a line per row");
+
+    BoardLine line = GameBoardGetLine(gameBoard, SlideRight, 1);
+    ASSERT_INT_EQUAL(3, line.length, "rows should span every column");
+    ASSERT_INT_EQUAL(1, line.cells[0], "right lines should start at the right edge");
+    line = GameBoardGetLine(gameBoard, SlideLeft, 1);
+    ASSERT_INT_EQUAL(1, line.cells[2 * line.stride], "left lines should end at the right edge");
+    line = GameBoardGetLine(gameBoard, SlideDown, 2);
+    ASSERT_INT_EQUAL(2, line.length, "columns should span every row");
+    ASSERT_INT_EQUAL(1, line.cells[0], "down lines should start at the bottom edge");
+    line = GameBoardGetLine(gameBoard, SlideUp, 2);
+    ASSERT_INT_EQUAL(1, line.cells[line.stride], "up lines should end at the bottom edge");
+}
+
+void TESTEXPORT GameBoardCanSlideFindsGapsAndMerges(TestContext *context) {
+    gameBoard = GameBoardCreate(2, 2);
+    GameBoardAddTile(gameBoard, 0, 0);
+
+    ASSERT_FALSE(GameBoardCanSlide(gameBoard, SlideLeft), "tile is already against the left edge");
+    ASSERT_FALSE(GameBoardCanSlide(gameBoard, SlideUp), "tile is already against the top edge");
+    ASSERT_TRUE(GameBoardCanSlide(gameBoard, SlideRight), "tile has a gap to its right");
+    ASSERT_TRUE(GameBoardCanSlide(gameBoard, SlideDown), "tile has a gap below it");
+
+    GameBoardAddTile(gameBoard, 0, 1);
+    ASSERT_TRUE(GameBoardCanSlide(gameBoard, SlideLeft), "matching tiles should merge");
+}
+
+void TESTEXPORT GameBoardColumnMirrorMatchesInPlaceSlides(TestContext *context) {
+    gameBoard = GameBoardCreate(5, 7);
+    GameBoard *mirrored = GameBoardCreate(5, 7);
+    GameBoardSetHeadless(gameBoard, 1);
+    GameBoardSetHeadless(mirrored, 1);
+    GameBoardSetColumnMirror(mirrored, 1);
+    GameBoardSetSeed(gameBoard, 42);
+    GameBoardSetSeed(mirrored, 42);
+    ASSERT_TRUE(GameBoardUsesColumnMirror(mirrored), "mirror should be enabled");
+
+    static const SlideDirection moves[] = { SlideUp, SlideUp, SlideLeft, SlideDown, SlideDown, SlideRight };
+    GameBoardCell cell;
+    for (int i = 0; i < 120; i++) {
+        if (GameBoardTryGetOpenCell(gameBoard, &cell)) {
+            GameBoardAddTile(gameBoard, cell.row, cell.col);
+        }
+        if (GameBoardTryGetOpenCell(mirrored, &cell)) {
+            GameBoardAddTile(mirrored, cell.row, cell.col);
+        }
+        SlideDirection direction = moves[i % (sizeof(moves) / sizeof(moves[0]))];
+        ASSERT_INT_EQUAL(GameBoardTrySlide(gameBoard, direction), GameBoardTrySlide(mirrored, direction), "boards should agree on sliding");
+    }
+
+    uint8_t expected[256], actual[256];
+    size_t size = GameBoardSaveSnapshot(gameBoard, expected, sizeof(expected));
+    ASSERT_INT_EQUAL(size, GameBoardSaveSnapshot(mirrored, actual, sizeof(actual)), "snapshots should be the same size");
+    ASSERT_FALSE(memcmp(expected, actual, size), "mirrored board should end up the same");
+    GameBoardDispose(mirrored);
+}
+
+void TESTEXPORT GameBoardColumnMirrorMergesFromTheEdge(TestContext *context) {
+    gameBoard = GameBoardCreate(3, 2);
+    GameBoardSetHeadless(gameBoard, 1);
+    GameBoardSetColumnMirror(gameBoard, 1);
+    GameBoardAddTile(gameBoard, 0, 1);
+    GameBoardAddTile(gameBoard, 1, 1);
+    GameBoardAddTile(gameBoard, 2, 1);
+
+    ASSERT_TRUE(GameBoardTrySlide(gameBoard, SlideDown), "column should slide");
+    ASSERT_INT_EQUAL(2, GameBoardGetExponent(gameBoard, 2, 1), "bottom pair should merge");
+    ASSERT_INT_EQUAL(1, GameBoardGetExponent(gameBoard, 1, 1), "top tile should slide down");
+    ASSERT_INT_EQUAL(0, GameBoardGetExponent(gameBoard, 0, 1), "top cell should be empty");
+    ASSERT_INT_EQUAL(0, GameBoardGetExponent(gameBoard, 2, 0), "other column should be untouched");
+}
+
+void TESTEXPORT GameBoard_Score_StartsAtZero(TestContext *context) {
+    gameBoard = GameBoardCreate(1, 2);
+    ASSERT_TRUE(GameBoardGetScore(gameBoard) == 0, "new board should have no score");
+}
+
+void TESTEXPORT GameBoard_Score_SlideWithoutMergeScoresNothing(TestContext *context) {
+    gameBoard = GameBoardCreate(1, 2);
+    GameBoardAddTile(gameBoard, 0, 1);
+    uint64_t delta = 1;
+
+    ASSERT_TRUE(GameBoardTrySlideWithScore(gameBoard, SlideLeft, &delta), "tile should slide");
+    ASSERT_TRUE(delta == 0, "sliding should not score");
+    ASSERT_TRUE(GameBoardGetScore(gameBoard) == 0, "sliding should not score");
+}
+
+void TESTEXPORT GameBoard_Score_MergeAddsMergedValue(TestContext *context) {
+    gameBoard = GameBoardCreate(2, 3);
+    GameBoardAddTile(gameBoard, 0, 0);
+    GameBoardAddTile(gameBoard, 0, 1);
+    GameBoardAddTile(gameBoard, 1, 1);
+    GameBoardAddTile(gameBoard, 1, 2);
+    uint64_t delta = 0;
+
+    GameBoardTrySlideWithScore(gameBoard, SlideLeft, &delta);
+    ASSERT_INT_EQUAL(8, (int)delta, "two merges into 4 should score 8");
+
+    GameBoardTrySlideWithScore(gameBoard, SlideUp, &delta);
+    ASSERT_INT_EQUAL(8, (int)delta, "merging the 4s should score 8");
+    ASSERT_INT_EQUAL(16, (int)GameBoardGetScore(gameBoard), "score should accumulate");
+}
+
+void TESTEXPORT GameBoard_Diff_AddTileSendsOneDiff(TestContext *context) {
+    gameBoard = GameBoardCreate(1, 2);
+    GameBoardAddTileAddRemoveHandler(gameBoard, &tileAddCount, TestHandleAddRemoveTile);
+    GameBoardAddDiffHandler(gameBoard, 0, TestHandleDiff);
+
+    GameBoardAddTile(gameBoard, 0, 1);
+
+    ASSERT_INT_EQUAL(1, tileAddCount, "add/remove listener should still get its notification");
+    ASSERT_PTR_EQUAL(GameBoardGetTile(gameBoard, 0, 1), tileAdded, "add/remove listener should get the new tile");
+    ASSERT_INT_EQUAL(1, diffCount, "should send a single diff");
+    ASSERT_INT_EQUAL(1, lastDiff.numChanges, "should have a single change");
+    ASSERT_INT_EQUAL(BoardChangeAdd, lastChanges[0].kind, "should be an add");
+    ASSERT_INT_EQUAL(1, lastChanges[0].to.col, "should add at column 1");
+}
+
+void TESTEXPORT GameBoard_Diff_SlideSendsMovesAndMerges(TestContext *context) {
+    gameBoard = GameBoardCreate(1, 4);
+    GameBoardAddTile(gameBoard, 0, 2);
+    GameBoardAddTile(gameBoard, 0, 3);
+    GameBoardAddTileAddRemoveHandler(gameBoard, &tileAddCount, TestHandleAddRemoveTile);
+    GameBoardAddDiffHandler(gameBoard, 0, TestHandleDiff);
+
+    GameBoardTrySlide(gameBoard, SlideLeft);
+
+    ASSERT_TRUE(tileAddCount > 0, "add/remove listener should still get per-tile notifications");
+    ASSERT_NOT_NULL(tileRemoved, "add/remove listener should see the merged tile go");
+    ASSERT_INT_EQUAL(1, diffCount, "should send a single diff for the whole slide");
+    ASSERT_INT_EQUAL(2, lastDiff.numChanges, "should have one move and one merge");
+    ASSERT_INT_EQUAL(4, (int)lastDiff.scoreDelta, "should report the score for the move");
+
+    const BoardChange *move = FindChange(BoardChangeMove);
+    ASSERT_NOT_NULL((void *)move, "should have a move");
+    ASSERT_INT_EQUAL(2, move->from.col, "should move from where the tile started");
+    ASSERT_INT_EQUAL(0, move->to.col, "should move to where the tile ended");
+    ASSERT_INT_EQUAL(2, move->exponent, "should report the final exponent");
+
+    const BoardChange *merge = FindChange(BoardChangeMerge);
+    ASSERT_NOT_NULL((void *)merge, "should have a merge");
+    ASSERT_INT_EQUAL(3, merge->from.col, "should merge from where the consumed tile started");
+    ASSERT_INT_EQUAL(0, merge->to.col, "should merge into the final cell");
+}
+
+void TESTEXPORT GameBoard_Diff_RemovedHandlerGetsPerTileNotifications(TestContext *context) {
+    gameBoard = GameBoardCreate(1, 2);
+    GameBoardAddTileAddRemoveHandler(gameBoard, &tileAddCount, TestHandleAddRemoveTile);
+    GameBoardAddDiffHandler(gameBoard, 0, TestHandleDiff);
+    GameBoardRemoveDiffHandler(gameBoard, TestHandleDiff);
+
+    GameBoardAddTile(gameBoard, 0, 1);
+
+    ASSERT_INT_EQUAL(1, tileAddCount, "should go back to per-tile notifications");
+    ASSERT_INT_EQUAL(0, diffCount, "should not send a diff");
+}
+
+void TESTEXPORT GameBoard_SubscribingMidSlideStartsWithNextChange(TestContext *context) {
+    gameBoard = GameBoardCreate(1, 4);
+    GameBoardAddTile(gameBoard, 0, 0);
+    GameBoardAddTile(gameBoard, 0, 1);
+    GameBoardAddTile(gameBoard, 0, 3);
+    // The first merge fires this, before the tile at column 3 has moved.
+    TileAddValueChangeHandler(GameBoardGetTile(gameBoard, 0, 0), TestSubscribeDuringSlide, 0);
+
+    GameBoardTrySlide(gameBoard, SlideLeft);
+
+    ASSERT_INT_EQUAL(2, GameBoardGetExponent(gameBoard, 0, 0), "should have merged");
+    ASSERT_INT_EQUAL(1, GameBoardGetExponent(gameBoard, 0, 1), "should have moved the last tile");
+    ASSERT_INT_EQUAL(0, tileAddCount, "listener added mid-slide should not see the rest of it");
+
+    GameBoardAddTile(gameBoard, 0, 3);
+    ASSERT_INT_EQUAL(1, tileAddCount, "listener should get the next change");
+}
+
+void TESTEXPORT GameBoard_Diff_ResetHandlerGetsReset(TestContext *context) {
+    gameBoard = GameBoardCreate(1, 2);
+    GameBoardSetHeadless(gameBoard, 1);
+    GameBoardAddDiffHandler(gameBoard, 0, TestHandleDiff);
+    GameBoardAddResetHandler(gameBoard, &tileResetCount, TestHandleReset);
+    GameBoardAddTile(gameBoard, 0, 1);
+
+    GameBoardSetHeadless(gameBoard, 0);
+
+    ASSERT_INT_EQUAL(1, tileResetCount, "reset handler should get the reset");
+    ASSERT_INT_EQUAL(0, diffCount, "should not send a diff");
+}
+
+void TESTEXPORT GameBoard_NestedNotificationKeepsTile(TestContext *context) {
+    gameBoard = GameBoardCreate(1, 2);
+    GameBoard *other = GameBoardCreate(1, 2);
+    int otherCount = 0;
+    GameBoardAddTileAddRemoveHandler(other, &otherCount, TestHandleAddRemoveTile);
+    GameBoardAddTileAddRemoveHandler(gameBoard, other, TestHandleAddToOtherBoard);
+    GameBoardAddTileAddRemoveHandler(gameBoard, &tileAddCount, TestHandleAddRemoveTile);
+
+    GameBoardAddTile(gameBoard, 0, 1);
+
+    ASSERT_INT_EQUAL(1, otherCount, "other board should have notified its own listener");
+    ASSERT_INT_EQUAL(1, tileAddCount, "should still notify the second listener");
+    ASSERT_PTR_EQUAL(GameBoardGetTile(gameBoard, 0, 1), tileAdded, "second listener should get this board's tile");
+    GameBoardDispose(other);
+}
+
+void TESTEXPORT GameBoard_Headless_SendsNoNotifications(TestContext *context) {
+    gameBoard = GameBoardCreate(1, 2);
+    GameBoardSetHeadless(gameBoard, 1);
+    GameBoardAddTileAddRemoveHandler(gameBoard, &tileAddCount, TestHandleAddRemoveTile);
+    GameBoardAddDiffHandler(gameBoard, 0, TestHandleDiff);
+
+    GameBoardAddTile(gameBoard, 0, 1);
+    GameBoardTrySlide(gameBoard, SlideLeft);
+
+    ASSERT_INT_EQUAL(0, tileAddCount, "should not send per-tile notifications");
+    ASSERT_INT_EQUAL(0, diffCount, "should not send diffs");
+    ASSERT_NOT_NULL(GameBoardGetTile(gameBoard, 0, 0), "should still slide");
+}
+
+void TESTEXPORT GameBoard_Headless_MergeSendsNoValueChange(TestContext *context) {
+    gameBoard = GameBoardCreate(1, 2);
+    GameBoardAddTile(gameBoard, 0, 0);
+    GameBoardAddTile(gameBoard, 0, 1);
+    int valueChangeCount = 0;
+    TileAddValueChangeHandler(GameBoardGetTile(gameBoard, 0, 0), TestCountValueChange, &valueChangeCount);
+    GameBoardSetHeadless(gameBoard, 1);
+
+    GameBoardTrySlide(gameBoard, SlideLeft);
+
+    ASSERT_INT_EQUAL(2, GameBoardGetExponent(gameBoard, 0, 0), "should still merge");
+    ASSERT_INT_EQUAL(0, valueChangeCount, "should not notify the merged tile");
+}
+
+void TESTEXPORT GameBoard_Headless_LeavingSendsReset(TestContext *context) {
+    gameBoard = GameBoardCreate(1, 2);
+    GameBoardSetHeadless(gameBoard, 1);
+    GameBoardAddTileAddRemoveHandler(gameBoard, &tileAddCount, TestHandleAddRemoveTile);
+    GameBoardAddTile(gameBoard, 0, 1);
+
+    GameBoardSetHeadless(gameBoard, 0);
+
+    ASSERT_INT_EQUAL(1, tileAddCount, "should send a single notification");
+    ASSERT_INT_EQUAL(1, tileResetCount, "should send a reset");
+    ASSERT_FALSE(GameBoardIsHeadless(gameBoard), "should no longer be headless");
+}
 /// REGION END
 
 static void DefaultInitGameBoard(TestContext *context) {
@@ -548,6 +981,9 @@ static void DefaultCleanupGameBoard(TestContext *context) {
     tileRemoved = 0;
     tileAddCount = 0;
     tileRemoveCount = 0;
+    tileResetCount = 0;
+    diffCount = 0;
+    memset(&lastDiff, 0, sizeof(lastDiff));
 }
 
 BEGIN_MODULE_TEST(gameboard)
@@ -563,6 +999,8 @@ BEGIN_MODULE_TEST(gameboard)
     ADD_TEST(GameBoardCanNotAddTile3, DefaultInitGameBoard, DefaultCleanupGameBoard)
     ADD_TEST(GameBoardTestAddTile, DefaultInitGameBoard, DefaultCleanupGameBoard)
     ADD_TEST(GameBoardGetTileFalse, DefaultInitGameBoard, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoardGetExponentReadsCell, DefaultInitGameBoard, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoardTileHandleStaysWithCell, DefaultInitGameBoard, DefaultCleanupGameBoard)
     ADD_TEST(GameBoardGetOpenTile, DefaultInitGameBoard, DefaultCleanupGameBoard)
     ADD_TEST(GameBoardNoOpenTiles, DefaultInitGameBoard, DefaultCleanupGameBoard)
     ADD_TEST(GameBoardGetOpenTileGetsAllTiles, 0, 0)
@@ -592,4 +1030,27 @@ BEGIN_MODULE_TEST(gameboard)
     ADD_TEST(GameBoard_SlideTiles_Down4, 0, DefaultCleanupGameBoard)
     ADD_TEST(GameBoard_SlideTiles_Down5, 0, DefaultCleanupGameBoard)
     ADD_TEST(GameBoard_SlideTiles_Down6, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoardLinesRunInSlideOrder, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoardCanSlideFindsGapsAndMerges, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoardColumnMirrorMatchesInPlaceSlides, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoardColumnMirrorMergesFromTheEdge, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_Score_StartsAtZero, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_Score_SlideWithoutMergeScoresNothing, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_Score_MergeAddsMergedValue, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_NestedNotificationKeepsTile, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_Headless_SendsNoNotifications, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_Headless_MergeSendsNoValueChange, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_Headless_LeavingSendsReset, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_Diff_AddTileSendsOneDiff, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_Diff_SlideSendsMovesAndMerges, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_Diff_RemovedHandlerGetsPerTileNotifications, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_Diff_ResetHandlerGetsReset, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_SubscribingMidSlideStartsWithNextChange, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_Snapshot_RoundTrip, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_Snapshot_RestoresRandomState, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_Snapshot_RejectsBadSnapshot, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_Snapshot_RejectsOversizedDimensions, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_Snapshot_RestoreNotifiesPerTile, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_Snapshot_RestoreSendsDiff, 0, DefaultCleanupGameBoard)
+    ADD_TEST(GameBoard_Snapshot_RestoreNotifiesReset, 0, DefaultCleanupGameBoard)
 END_MODULE_TEST
@@ -0,0 +1,153 @@
+#include <ansi_c.h>
+#include "../../CVI_Core/log.h"
+#include "../../CVI_Test/CVI_Test.h"
+#include "../../2048/2048/history.h"
+
+#define NUM_ROWS 2
+#define NUM_COLS 2
+
+static GameBoard *gameBoard;
+static GameHistory *history;
+static char current[64];
+static char restored[64];
+static size_t snapshotSize;
+
+static void SaveCurrent(void) {
+    snapshotSize = GameBoardSaveSnapshot(gameBoard, current, sizeof(current));
+}
+
+// Overwrites every cell of a saved snapshot, for steps that need not be reachable by play.
+static void FillSnapshot(void *snapshot, uint32_t numCells, uint8_t exponent) {
+    memset((uint8_t *)snapshot + sizeof(GameBoardSnapshotHeader), exponent, numCells);
+}
+
+/// REGION START Tests
+void TESTEXPORT History_NothingToUndo(TestContext *context) {
+    SaveCurrent();
+    ASSERT_FALSE(GameHistoryCanUndo(history), "should not be able to undo");
+    ASSERT_FALSE(GameHistoryCanRedo(history), "should not be able to redo");
+    ASSERT_FALSE(GameHistoryUndo(history, current, restored, snapshotSize), "undo should fail");
+}
+
+void TESTEXPORT History_UndoRestoresPreviousBoard(TestContext *context) {
+    GameBoardAddTile(gameBoard, 0, 1);
+    SaveCurrent();
+    GameHistoryPush(history, current, snapshotSize);
+    GameBoardTrySlide(gameBoard, SlideLeft);
+    SaveCurrent();
+
+    ASSERT_TRUE(GameHistoryUndo(history, current, restored, snapshotSize), "undo should succeed");
+    GameBoardRestoreSnapshot(gameBoard, restored, snapshotSize, RestoreNotifyPerTile);
+
+    ASSERT_IS_NULL(GameBoardGetTile(gameBoard, 0, 0), "tile should be back where it started");
+    ASSERT_NOT_NULL(GameBoardGetTile(gameBoard, 0, 1), "tile should be back where it started");
+    ASSERT_TRUE(GameHistoryCanRedo(history), "should be able to redo");
+}
+
+void TESTEXPORT History_RedoRestoresUndoneBoard(TestContext *context) {
+    GameBoardAddTile(gameBoard, 0, 1);
+    SaveCurrent();
+    GameHistoryPush(history, current, snapshotSize);
+    GameBoardTrySlide(gameBoard, SlideLeft);
+    SaveCurrent();
+    GameHistoryUndo(history, current, restored, snapshotSize);
+    GameBoardRestoreSnapshot(gameBoard, restored, snapshotSize, RestoreNotifyPerTile);
+    SaveCurrent();
+
+    ASSERT_TRUE(GameHistoryRedo(history, current, restored, snapshotSize), "redo should succeed");
+    GameBoardRestoreSnapshot(gameBoard, restored, snapshotSize, RestoreNotifyPerTile);
+
+    ASSERT_NOT_NULL(GameBoardGetTile(gameBoard, 0, 0), "tile should be slid again");
+    ASSERT_IS_NULL(GameBoardGetTile(gameBoard, 0, 1), "tile should be slid again");
+    ASSERT_FALSE(GameHistoryCanRedo(history), "nothing left to redo");
+}
+
+void TESTEXPORT History_PushClearsRedo(TestContext *context) {
+    SaveCurrent();
+    GameHistoryPush(history, current, snapshotSize);
+    GameHistoryUndo(history, current, restored, snapshotSize);
+    GameHistoryPush(history, current, snapshotSize);
+
+    ASSERT_FALSE(GameHistoryCanRedo(history), "pushing a new move should drop redo");
+}
+
+void TESTEXPORT History_UndoWalksBackEveryStep(TestContext *context) {
+    uint32_t numCells = NUM_ROWS * NUM_COLS;
+    for (uint32_t i = 0; i < numCells; i++) {
+        SaveCurrent();
+        GameHistoryPush(history, current, snapshotSize);
+        GameBoardAddTile(gameBoard, i / NUM_COLS, i % NUM_COLS);
+    }
+
+    for (uint32_t i = numCells; i-- > 0;) {
+        SaveCurrent();
+        ASSERT_TRUE(GameHistoryUndo(history, current, restored, snapshotSize), "undo should succeed");
+        GameBoardRestoreSnapshot(gameBoard, restored, snapshotSize, RestoreNotifyPerTile);
+        ASSERT_IS_NULL(GameBoardGetTile(gameBoard, i / NUM_COLS, i % NUM_COLS), "undo should remove the last tile added");
+        ASSERT_TRUE(i == 0 || GameBoardGetTile(gameBoard, (i - 1) / NUM_COLS, (i - 1) % NUM_COLS), "undo went back too far");
+    }
+    ASSERT_FALSE(GameHistoryCanUndo(history), "nothing left to undo");
+}
+
+void TESTEXPORT History_DepthIsCapped(TestContext *context) {
+    SaveCurrent();
+    GameHistorySetMaxDepth(history, 3);
+    for (uint8_t i = 1; i <= 5; i++) {
+        FillSnapshot(current, NUM_ROWS * NUM_COLS, i);
+        GameHistoryPush(history, current, snapshotSize);
+    }
+
+    for (uint8_t i = 5; i >= 3; i--) {
+        ASSERT_TRUE(GameHistoryUndo(history, current, restored, snapshotSize), "undo should succeed");
+        ASSERT_INT_EQUAL(i, ((uint8_t *)restored)[sizeof(GameBoardSnapshotHeader)], "undo restored the wrong step");
+    }
+    ASSERT_FALSE(GameHistoryUndo(history, current, restored, snapshotSize), "steps beyond the cap should be gone");
+}
+
+void TESTEXPORT History_StepsStoreOnlyChangedCells(TestContext *context) {
+    GameBoard *wide = GameBoardCreate(64, 64);
+    GameHistory *deep = GameHistoryCreate(64, 64);
+    size_t size = GameBoardSnapshotSize(wide);
+    uint8_t *snapshot = calloc(1, size);
+    GameBoardSaveSnapshot(wide, snapshot, size);
+    uint8_t *cells = snapshot + sizeof(GameBoardSnapshotHeader);
+
+    for (uint32_t i = 0; i < 1000; i++) {
+        GameHistoryPush(deep, snapshot, size);
+        cells[i] = 1;
+    }
+    ASSERT_TRUE(GameHistoryBytesUsed(deep) < 100 * 1024, "1000 one-cell moves should cost kilobytes");
+
+    for (uint32_t i = 1000; i-- > 0;) {
+        ASSERT_TRUE(GameHistoryUndo(deep, snapshot, snapshot, size), "undo should succeed");
+        ASSERT_INT_EQUAL(0, cells[i], "undo should clear the cell that step set");
+        ASSERT_TRUE(i == 0 || cells[i - 1] == 1, "undo went back too far");
+    }
+    free(snapshot);
+    GameHistoryDispose(deep);
+    GameBoardDispose(wide);
+}
+/// REGION END
+
+static void DefaultInitHistory(TestContext *context) {
+    gameBoard = GameBoardCreate(NUM_ROWS, NUM_COLS);
+    history = GameHistoryCreate(NUM_ROWS, NUM_COLS);
+}
+
+static void DefaultCleanupHistory(TestContext *context) {
+    GameHistoryDispose(history);
+    GameBoardDispose(gameBoard);
+    history = 0;
+    gameBoard = 0;
+    snapshotSize = 0;
+}
+
+BEGIN_MODULE_TEST(history)
+    ADD_TEST(History_NothingToUndo, DefaultInitHistory, DefaultCleanupHistory)
+    ADD_TEST(History_UndoRestoresPreviousBoard, DefaultInitHistory, DefaultCleanupHistory)
+    ADD_TEST(History_RedoRestoresUndoneBoard, DefaultInitHistory, DefaultCleanupHistory)
+    ADD_TEST(History_PushClearsRedo, DefaultInitHistory, DefaultCleanupHistory)
+    ADD_TEST(History_UndoWalksBackEveryStep, DefaultInitHistory, DefaultCleanupHistory)
+    ADD_TEST(History_DepthIsCapped, DefaultInitHistory, DefaultCleanupHistory)
+    ADD_TEST(History_StepsStoreOnlyChangedCells, DefaultInitHistory, DefaultCleanupHistory)
+END_MODULE_TEST
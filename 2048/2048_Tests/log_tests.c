@@ -0,0 +1,110 @@
+#include <ansi_c.h>
+#include <utility.h>
+#include "../../CVI_Test/CVI_Test.h"
+#include "../../CVI_Core/log.h"
+
+#define NUM_WRITERS 4
+#define RECORDS_PER_WRITER 200
+
+static Log *testLog;
+static char captured[64 * 1024];
+static size_t capturedLength;
+
+static void CaptureRecords(Log *log, const char *records, size_t length, void *data);
+static int CVICALLBACK WriteRecords(void *data);
+
+/// REGION START Tests
+
+void TESTEXPORT LogWriteReachesSinkOnFlush(TestContext *context) {
+    LogWrite(testLog, LogLevelInfo, "score %d", 42);
+    LogFlush(testLog);
+
+    ASSERT_STRING_EQUAL("[INFO] score 42\n", captured, "record should be formatted with its level!");
+}
+
+void TESTEXPORT LogCutsLongRecordsShort(TestContext *context) {
+    char message[2048];
+    memset(message, 'x', sizeof(message) - 1);
+    message[sizeof(message) - 1] = 0;
+    LogWrite(testLog, LogLevelError, "%s", message);
+    LogFlush(testLog);
+
+    ASSERT_TRUE(capturedLength < sizeof(message), "record should have been cut short!");
+    ASSERT_INT_EQUAL('\n', captured[capturedLength - 1], "a cut record should still end its line!");
+}
+
+void TESTEXPORT LogKeepsEachThreadsRecordsInOrder(TestContext *context) {
+    CmtThreadFunctionID ids[NUM_WRITERS];
+    for (int i = 0; i < NUM_WRITERS; i++) {
+        CmtScheduleThreadPoolFunction(DEFAULT_THREAD_POOL_HANDLE, WriteRecords, (void *)(intptr_t)i, &ids[i]);
+    }
+    for (int i = 0; i < NUM_WRITERS; i++) {
+        CmtWaitForThreadPoolFunctionCompletion(DEFAULT_THREAD_POOL_HANDLE, ids[i], 0);
+        CmtReleaseThreadPoolFunctionID(DEFAULT_THREAD_POOL_HANDLE, ids[i]);
+    }
+    LogFlush(testLog);
+
+    int next[NUM_WRITERS] = { 0 };
+    int total = 0;
+    for (char *line = strtok(captured, "\n"); line; line = strtok(0, "\n"), total++) {
+        int writer, record;
+        ASSERT_INT_EQUAL(2, sscanf(line, "[DEBUG] %d %d", &writer, &record), "record was mangled!");
+        ASSERT_INT_EQUAL(next[writer], record, "records from one thread out of order!");
+        next[writer]++;
+    }
+    ASSERT_INT_EQUAL(NUM_WRITERS * RECORDS_PER_WRITER, total, "records went missing!");
+}
+
+void TESTEXPORT LogKeepsRecordsOfExitedThreads(TestContext *context) {
+    // Each writer's buffer may be freed once its thread is gone; nothing it wrote may be lost.
+    for (int i = 0; i < NUM_WRITERS; i++) {
+        CmtThreadFunctionID id;
+        CmtScheduleThreadPoolFunction(DEFAULT_THREAD_POOL_HANDLE, WriteRecords, (void *)(intptr_t)i, &id);
+        CmtWaitForThreadPoolFunctionCompletion(DEFAULT_THREAD_POOL_HANDLE, id, 0);
+        CmtReleaseThreadPoolFunctionID(DEFAULT_THREAD_POOL_HANDLE, id);
+        LogFlush(testLog);
+    }
+    LogFlush(testLog);
+
+    int total = 0;
+    for (char *line = strtok(captured, "\n"); line; line = strtok(0, "\n")) {
+        total++;
+    }
+    ASSERT_INT_EQUAL(NUM_WRITERS * RECORDS_PER_WRITER, total, "records from an exited thread went missing!");
+}
+/// REGION END
+
+static void CaptureRecords(Log *log, const char *records, size_t length, void *data) {
+    if (capturedLength + length < sizeof(captured)) {
+        memcpy(captured + capturedLength, records, length);
+        capturedLength += length;
+        captured[capturedLength] = 0;
+    }
+}
+
+static int CVICALLBACK WriteRecords(void *data) {
+    int writer = (int)(intptr_t)data;
+    for (int i = 0; i < RECORDS_PER_WRITER; i++) {
+        LogWrite(testLog, LogLevelDebug, "%d %d", writer, i);
+    }
+    return 0;
+}
+
+static void InitLogTest(TestContext *context) {
+    testLog = LogCreate();
+    LogSetSink(testLog, CaptureRecords, 0);
+    capturedLength = 0;
+    captured[0] = 0;
+}
+
+static void CleanupLogTest(TestContext *context) {
+    LogDispose(testLog);
+    testLog = 0;
+}
+
+BEGIN_MODULE_TEST(log)
+    ADD_TEST(LogWriteReachesSinkOnFlush, InitLogTest, CleanupLogTest)
+    ADD_TEST(LogCutsLongRecordsShort, InitLogTest, CleanupLogTest)
+    ADD_TEST(LogKeepsEachThreadsRecordsInOrder, InitLogTest, CleanupLogTest)
+    ADD_TEST(LogKeepsRecordsOfExitedThreads, InitLogTest, CleanupLogTest)
+END_MODULE_TEST
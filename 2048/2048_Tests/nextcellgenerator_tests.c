@@ -74,6 +74,29 @@ void TESTEXPORT NextCellGenerator_SlideRight(TestContext *context) {
     };
     RunGeneratorTest(context, cells, SlideRight);
 }
+
+void TESTEXPORT NextCellGenerator_PairsMatchCells(TestContext *context) {
+    generator = CellGeneratorCreate(gameBoard, SlideDown);
+    const CellIndexPair *pairs;
+    uint32_t numPairs = CellGeneratorGetPairs(generator, &pairs);
+    ASSERT_INT_EQUAL(6, numPairs, "should have a pair for each of 6 tiles!");
+    uint32_t i;
+    for (i = 0; CellGeneratorMoveNext(generator); i++) {
+        ASSERT_TRUE(i < numPairs, "generator yielded more cells than there are pairs!");
+        GameBoardCell target, toSlide;
+        CellGeneratorGetCurrent(generator, &toSlide, &target);
+        ASSERT_INT_EQUAL(toSlide.col + toSlide.row * NUM_COLS, pairs[i].source, "wrong source index");
+        ASSERT_INT_EQUAL(target.col + target.row * NUM_COLS, pairs[i].target, "wrong target index");
+    }
+    ASSERT_INT_EQUAL(numPairs, i, "generator yielded fewer cells than there are pairs!");
+}
+
+void TESTEXPORT NextCellGenerator_NarrowBoardHasNoPairs(TestContext *context) {
+    GameBoard *narrow = GameBoardCreate(NUM_ROWS, 1);
+    generator = CellGeneratorCreate(narrow, SlideLeft);
+    ASSERT_FALSE(CellGeneratorMoveNext(generator), "a single column can not slide left!");
+    GameBoardDispose(narrow);
+}
 /// REGION END
 
 static void DefaultInitNextCellGenerator(TestContext *context) {
@@ -92,4 +115,6 @@ BEGIN_MODULE_TEST(nextcellgenerator)
     ADD_TEST(NextCellGenerator_SlideDown, DefaultInitNextCellGenerator, DefaultCleanupNextCellGenerator)
     ADD_TEST(NextCellGenerator_SlideLeft, DefaultInitNextCellGenerator, DefaultCleanupNextCellGenerator)
     ADD_TEST(NextCellGenerator_SlideRight, DefaultInitNextCellGenerator, DefaultCleanupNextCellGenerator)
+    ADD_TEST(NextCellGenerator_PairsMatchCells, DefaultInitNextCellGenerator, DefaultCleanupNextCellGenerator)
+    ADD_TEST(NextCellGenerator_NarrowBoardHasNoPairs, DefaultInitNextCellGenerator, DefaultCleanupNextCellGenerator)
 END_MODULE_TEST
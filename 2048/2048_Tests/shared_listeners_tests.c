@@ -0,0 +1,148 @@
+#include <ansi_c.h>
+#include "../../CVI_Test/CVI_Test.h"
+#include "../../2048/2048/shared_listeners.h"
+
+static SharedListenerList *listeners;
+static ChangeData changeData;
+static int notifyCount;
+static int clearCount;
+static int clearedDuringDispatch;
+static int dispatching;
+static ListenerHandle selfHandle;
+
+static void HandleNotification(void *target, void *data, void *args);
+static void HandleRemoveSelf(void *target, void *data, void *args);
+static void HandleAddAnother(void *target, void *data, void *args);
+static void HandleClearData(void *data);
+
+/// REGION START Tests
+
+void TESTEXPORT SharedGetsNotifications(TestContext *context) {
+    SharedListenersAdd(listeners, changeData);
+    SharedListenersAdd(listeners, changeData);
+    SharedListenersNotify(listeners, 0);
+
+    ASSERT_INT_EQUAL(2, notifyCount, "Not notified twice!");
+    ASSERT_INT_EQUAL(2, SharedListenersCount(listeners), "Wrong listener count!");
+}
+
+void TESTEXPORT SharedRemoveByHandleReleasesData(TestContext *context) {
+    int first, second;
+    ChangeData data1 = { .target = 0, .data = &first, .handler = HandleNotification };
+    ChangeData data2 = { .target = 0, .data = &second, .handler = HandleNotification };
+    ListenerHandle handle1 = SharedListenersAdd(listeners, data1);
+    SharedListenersAdd(listeners, data2);
+
+    ASSERT_TRUE(SharedListenersRemoveHandle(listeners, handle1, HandleClearData), "Listener was not removed!");
+    SharedListenersNotify(listeners, 0);
+
+    ASSERT_INT_EQUAL(1, notifyCount, "Removed listener was notified!");
+    ASSERT_INT_EQUAL(1, clearCount, "Removed data was not released!");
+}
+
+void TESTEXPORT SharedRemoveByStaleHandleIsIgnored(TestContext *context) {
+    ListenerHandle handle = SharedListenersAdd(listeners, changeData);
+    SharedListenersRemoveHandle(listeners, handle, 0);
+    SharedListenersAdd(listeners, changeData);
+
+    ASSERT_FALSE(SharedListenersRemoveHandle(listeners, handle, 0), "Removed by a stale handle!");
+    ASSERT_INT_EQUAL(1, SharedListenersCount(listeners), "Stale handle removed a listener!");
+}
+
+void TESTEXPORT SharedRemovedSlotIsReused(TestContext *context) {
+    ListenerHandle first = SharedListenersAdd(listeners, changeData);
+    ListenerHandle second = SharedListenersAdd(listeners, changeData);
+    SharedListenersRemoveHandle(listeners, first, 0);
+
+    ListenerHandle third = SharedListenersAdd(listeners, changeData);
+
+    ASSERT_INT_EQUAL(first.slot, third.slot, "Freed slot was not reused!");
+    ASSERT_TRUE(SharedListenersRemoveHandle(listeners, second, 0), "Other listener moved out of its slot!");
+    SharedListenersNotify(listeners, 0);
+    ASSERT_INT_EQUAL(1, notifyCount, "Only the newest listener should be left!");
+}
+
+void TESTEXPORT SharedRemoveDuringDispatchDefersRelease(TestContext *context) {
+    ChangeData removeSelf = { .target = 0, .data = &selfHandle, .handler = HandleRemoveSelf };
+    selfHandle = SharedListenersAdd(listeners, removeSelf);
+    SharedListenersAdd(listeners, changeData);
+
+    SharedListenersNotify(listeners, 0);
+
+    ASSERT_INT_EQUAL(1, notifyCount, "Dispatch should finish on the list it started with!");
+    ASSERT_FALSE(clearedDuringDispatch, "Data was released while still being dispatched!");
+    ASSERT_INT_EQUAL(1, clearCount, "Data was not released after dispatch!");
+    ASSERT_INT_EQUAL(1, SharedListenersCount(listeners), "Listener did not remove itself!");
+}
+
+void TESTEXPORT SharedAddDuringDispatchTakesEffectNextTime(TestContext *context) {
+    ChangeData addAnother = { .target = 0, .data = 0, .handler = HandleAddAnother };
+    SharedListenersAdd(listeners, addAnother);
+
+    SharedListenersNotify(listeners, 0);
+    ASSERT_INT_EQUAL(0, notifyCount, "Listener added during dispatch was notified!");
+
+    SharedListenersNotify(listeners, 0);
+    ASSERT_INT_EQUAL(1, notifyCount, "Listener added during dispatch was not notified later!");
+}
+
+void TESTEXPORT SharedDisposeReleasesData(TestContext *context) {
+    SharedListenersAdd(listeners, changeData);
+    SharedListenersAdd(listeners, changeData);
+    SharedListenersDispose(listeners, HandleClearData);
+    listeners = 0;
+
+    ASSERT_INT_EQUAL(2, clearCount, "Data was not released on dispose!");
+}
+/// REGION END
+
+static void HandleNotification(void *target, void *data, void *args) {
+    notifyCount++;
+}
+
+static void HandleRemoveSelf(void *target, void *data, void *args) {
+    dispatching = 1;
+    SharedListenersRemoveHandle(listeners, *(ListenerHandle *)data, HandleClearData);
+    dispatching = 0;
+}
+
+static void HandleAddAnother(void *target, void *data, void *args) {
+    // Only add once, the second dispatch sees both listeners.
+    if (SharedListenersCount(listeners) == 1) {
+        SharedListenersAdd(listeners, changeData);
+    }
+}
+
+static void HandleClearData(void *data) {
+    clearCount++;
+    clearedDuringDispatch |= dispatching;
+}
+
+static void InitSharedListenersTest(TestContext *context) {
+    listeners = SharedListenersCreate();
+    notifyCount = 0;
+    clearCount = 0;
+    clearedDuringDispatch = 0;
+    dispatching = 0;
+    changeData.data = 0;
+    changeData.target = 0;
+    changeData.handler = HandleNotification;
+}
+
+static void CleanupSharedListenersTest(TestContext *context) {
+    if (listeners) {
+        SharedListenersDispose(listeners, 0);
+        listeners = 0;
+    }
+    memset(&changeData, 0, sizeof(changeData));
+}
+
+BEGIN_MODULE_TEST(shared_listeners)
+    ADD_TEST(SharedGetsNotifications, InitSharedListenersTest, CleanupSharedListenersTest)
+    ADD_TEST(SharedRemoveByHandleReleasesData, InitSharedListenersTest, CleanupSharedListenersTest)
+    ADD_TEST(SharedRemoveByStaleHandleIsIgnored, InitSharedListenersTest, CleanupSharedListenersTest)
+    ADD_TEST(SharedRemovedSlotIsReused, InitSharedListenersTest, CleanupSharedListenersTest)
+    ADD_TEST(SharedRemoveDuringDispatchDefersRelease, InitSharedListenersTest, CleanupSharedListenersTest)
+    ADD_TEST(SharedAddDuringDispatchTakesEffectNextTime, InitSharedListenersTest, CleanupSharedListenersTest)
+    ADD_TEST(SharedDisposeReleasesData, InitSharedListenersTest, CleanupSharedListenersTest)
+END_MODULE_TEST
@@ -0,0 +1,172 @@
+#include <ansi_c.h>
+#include "../../CVI_Test/CVI_Test.h"
+#include "../../2048/2048/terminal.h"
+
+#define SCREEN_ROWS 32
+#define SCREEN_COLS 64
+
+// Just enough of an ANSI terminal to replay the output: cursor moves, clears and plain characters.
+typedef struct VirtualScreen {
+    char cells[SCREEN_ROWS][SCREEN_COLS];
+    int row;
+    int col;
+} VirtualScreen;
+
+static GameBoard *gameBoard;
+static Controller *controller;
+static Terminal *terminal;
+static VirtualScreen screen;
+static size_t lastWriteLength;
+static int lastWriteCleared;
+
+static void HandleWrite(const char *bytes, size_t length, void *data);
+static void Replay(VirtualScreen *target, const char *bytes, size_t length);
+static void ReplayFullRedraw(VirtualScreen *target);
+
+/// REGION START Tests
+
+void TESTEXPORT CreatePaintsWholeScreen(TestContext *context) {
+    ASSERT_INT_EQUAL(1, TerminalWriteCount(terminal), "wrong number of writes!");
+    ASSERT_TRUE(lastWriteCleared, "first paint did not clear the screen!");
+    ASSERT_TRUE(strstr(screen.cells[0], "Score: 0") != 0, "title missing!");
+}
+
+void TESTEXPORT StartGameShowsOneTile(TestContext *context) {
+    ControllerStartGame(controller);
+
+    int tiles = 0;
+    for (int row = 1; row < SCREEN_ROWS; row++) {
+        for (int col = 0; col < SCREEN_COLS; col++) {
+            tiles += screen.cells[row][col] == '2';
+        }
+    }
+    ASSERT_INT_EQUAL(1, tiles, "a fresh game should show exactly one tile!");
+
+    uint32_t writes = TerminalWriteCount(terminal);
+    ControllerStartGame(controller);
+    ASSERT_INT_EQUAL(writes, TerminalWriteCount(terminal), "starting a started game should change nothing!");
+}
+
+void TESTEXPORT UpdateIsOneWrite(TestContext *context) {
+    GameBoardAddTile(gameBoard, 0, 3);
+    uint32_t writes = TerminalWriteCount(terminal);
+
+    ControllerHandleSlide(controller, SlideLeft);
+
+    ASSERT_INT_EQUAL(writes + 1, TerminalWriteCount(terminal), "slide was not one write!");
+    ASSERT_FALSE(lastWriteCleared, "slide repainted the whole screen!");
+}
+
+void TESTEXPORT UnchangedBoardWritesNothing(TestContext *context) {
+    GameBoardAddTile(gameBoard, 0, 0);
+    uint32_t writes = TerminalWriteCount(terminal);
+
+    ControllerHandleSlide(controller, SlideLeft);
+
+    ASSERT_INT_EQUAL(writes, TerminalWriteCount(terminal), "wrote without a change!");
+}
+
+void TESTEXPORT UpdateWritesLessThanRedraw(TestContext *context) {
+    uint64_t firstPaint = TerminalBytesWritten(terminal);
+    GameBoardAddTile(gameBoard, 0, 3);
+    uint64_t before = TerminalBytesWritten(terminal);
+
+    ControllerHandleSlide(controller, SlideLeft);
+
+    ASSERT_TRUE(TerminalBytesWritten(terminal) - before < firstPaint / 4, "update wrote too much!");
+}
+
+void TESTEXPORT UpdatesMatchFullRedraw(TestContext *context) {
+    GameBoardAddTile(gameBoard, 0, 0);
+    SlideDirection moves[] = { SlideRight, SlideDown, SlideLeft, SlideUp, SlideRight, SlideDown, SlideLeft, SlideDown };
+    for (int i = 0; i < sizeof(moves) / sizeof(moves[0]); i++) {
+        ControllerHandleSlide(controller, moves[i]);
+        TimerWheelAdvance(ControllerGetTimers(controller), 1);
+    }
+
+    VirtualScreen expected;
+    ReplayFullRedraw(&expected);
+    for (int row = 0; row < SCREEN_ROWS; row++) {
+        ASSERT_TRUE(!memcmp(expected.cells[row], screen.cells[row], SCREEN_COLS), "screen out of sync with the board!");
+    }
+}
+
+void TESTEXPORT TerminalDisposeDetachesFromController(TestContext *context) {
+    VirtualScreen ignored;
+    Terminal *other = TerminalCreate(gameBoard, controller, HandleWrite, &ignored);
+    TerminalDispose(other);
+    GameBoardAddTile(gameBoard, 0, 0);
+
+    ControllerHandleSlide(controller, SlideRight);
+
+    ASSERT_NOT_NULL(GameBoardGetTile(gameBoard, 0, 3), "controller should carry on without a terminal!");
+}
+/// REGION END
+
+static void Replay(VirtualScreen *target, const char *bytes, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (bytes[i] != '\x1b') {
+            if (target->row < SCREEN_ROWS && target->col < SCREEN_COLS - 1) {
+                target->cells[target->row][target->col] = bytes[i];
+            }
+            target->col++;
+            continue;
+        }
+        // CSI: parameters up to the final letter.
+        size_t end = i + 2;
+        while (end < length && !isalpha((unsigned char)bytes[end])) {
+            end++;
+        }
+        if (bytes[end] == 'H') {
+            int row = 1, col = 1;
+            sscanf(bytes + i + 2, "%d;%d", &row, &col);
+            target->row = row - 1;
+            target->col = col - 1;
+        } else if (bytes[end] == 'J') {
+            memset(target->cells, 0, sizeof(target->cells));
+        }
+        i = end;
+    }
+}
+
+static void HandleWrite(const char *bytes, size_t length, void *data) {
+    VirtualScreen *target = (VirtualScreen *)data;
+    lastWriteLength = length;
+    lastWriteCleared = 0;
+    for (size_t i = 0; i + 4 <= length; i++) {
+        lastWriteCleared |= !memcmp(bytes + i, "\x1b[2J", 4);
+    }
+    Replay(target, bytes, length);
+}
+
+static void ReplayFullRedraw(VirtualScreen *target) {
+    memset(target, 0, sizeof(*target));
+    Terminal *other = TerminalCreate(gameBoard, 0, HandleWrite, target);
+    TerminalDispose(other);
+}
+
+static void InitTerminalTest(TestContext *context) {
+    memset(&screen, 0, sizeof(screen));
+    gameBoard = GameBoardCreate(4, 4);
+    controller = ControllerCreate(gameBoard);
+    terminal = TerminalCreate(gameBoard, controller, HandleWrite, &screen);
+}
+
+static void CleanupTerminalTest(TestContext *context) {
+    TerminalDispose(terminal);
+    ControllerDispose(controller);
+    GameBoardDispose(gameBoard);
+    controller = 0;
+    terminal = 0;
+    gameBoard = 0;
+}
+
+BEGIN_MODULE_TEST(terminal)
+    ADD_TEST(CreatePaintsWholeScreen, InitTerminalTest, CleanupTerminalTest)
+    ADD_TEST(StartGameShowsOneTile, InitTerminalTest, CleanupTerminalTest)
+    ADD_TEST(UpdateIsOneWrite, InitTerminalTest, CleanupTerminalTest)
+    ADD_TEST(UnchangedBoardWritesNothing, InitTerminalTest, CleanupTerminalTest)
+    ADD_TEST(UpdateWritesLessThanRedraw, InitTerminalTest, CleanupTerminalTest)
+    ADD_TEST(UpdatesMatchFullRedraw, InitTerminalTest, CleanupTerminalTest)
+    ADD_TEST(TerminalDisposeDetachesFromController, InitTerminalTest, CleanupTerminalTest)
+END_MODULE_TEST
@@ -75,6 +75,25 @@ void TESTEXPORT TestTileMerge(TestContext *context) {
     ASSERT_INT_EQUAL(original * 2, TileGetValue(tile1), "should have doubled tile value!");
 }
 
+void TESTEXPORT TileMergeGrowsPastUint32(TestContext *context) {
+    Tile *t1 = TileCreateWithExponent(0, 0, 40);
+    Tile *t2 = TileCreateWithExponent(0, 1, 40);
+    TileMerge(t1, t2);
+
+    ASSERT_INT_EQUAL(41, TileGetExponent(t1), "should have bumped the exponent!");
+
+    TileDispose(t1);
+    TileDispose(t2);
+}
+
+void TESTEXPORT TileCreateWithValueStoresExponent(TestContext *context) {
+    Tile *t = TileCreateWithValue(0, 0, 1024);
+
+    ASSERT_INT_EQUAL(10, TileGetExponent(t), "wrong exponent!");
+    ASSERT_INT_EQUAL(1024, TileGetValue(t), "wrong value!");
+    TileDispose(t);
+}
+
 void TESTEXPORT TileMergeNotifies(TestContext *context) {
     TileAddValueChangeHandler(tile1, TestMergeNotifies, 0);
     TileMerge(tile1, tile2);
@@ -147,6 +166,8 @@ BEGIN_MODULE_TEST(tile)
     ADD_TEST(TestTileGetColumn, DefaultInitTileTest, DefaultCleanupTileTest)
     ADD_TEST(TestTileCanMerge, DefaultInitTileTest, DefaultCleanupTileTest)
     ADD_TEST(TestTileMerge, DefaultInitTileTest, DefaultCleanupTileTest)
+    ADD_TEST(TileMergeGrowsPastUint32, DefaultInitTileTest, DefaultCleanupTileTest)
+    ADD_TEST(TileCreateWithValueStoresExponent, DefaultInitTileTest, DefaultCleanupTileTest)
     ADD_TEST(TileMergeNotifies, DefaultInitTileTest, DefaultCleanupTileTest)
     ADD_TEST(TileMergeNotifiesTwice, DefaultInitTileTest, DefaultCleanupTileTest)
     ADD_TEST(TileMergeNotifiesOnce, DefaultInitTileTest, DefaultCleanupTileTest)
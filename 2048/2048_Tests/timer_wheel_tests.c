@@ -0,0 +1,113 @@
+#include <ansi_c.h>
+#include "../../CVI_Test/CVI_Test.h"
+#include "../../2048/2048/timer_wheel.h"
+
+#define TICK .001
+
+static TimerWheel *wheel;
+static int fireCount;
+static double firedAt;
+static double fakeClock;
+
+static void HandleTimer(void *data);
+static void HandleRescheduleTimer(void *data);
+static double ReadFakeClock(void);
+
+/// REGION START Tests
+
+void TESTEXPORT TimerFiresAfterDelay(TestContext *context) {
+    TimerWheelSchedule(wheel, .2, HandleTimer, 0);
+
+    TimerWheelAdvance(wheel, .199);
+    ASSERT_INT_EQUAL(0, fireCount, "timer fired early!");
+    TimerWheelAdvance(wheel, .001);
+    ASSERT_INT_EQUAL(1, fireCount, "timer did not fire!");
+    ASSERT_INT_EQUAL(0, TimerWheelPending(wheel), "fired timer still pending!");
+}
+
+void TESTEXPORT TimerFiresOnTimeAcrossLevels(TestContext *context) {
+    // One delay per wheel level, plus one beyond the top level.
+    double delays[] = { .05, 3.5, 200.25, 9000, 20000 };
+    for (int i = 0; i < 5; i++) {
+        firedAt = -1;
+        TimerWheelSchedule(wheel, delays[i], HandleTimer, 0);
+        double start = TimerWheelNow(wheel);
+        TimerWheelAdvance(wheel, delays[i]);
+        ASSERT_TRUE(fabs(firedAt - (start + delays[i])) < TICK / 2, "timer fired at the wrong time!");
+    }
+    ASSERT_INT_EQUAL(5, fireCount, "not every timer fired!");
+}
+
+void TESTEXPORT CancelledTimerDoesNotFire(TestContext *context) {
+    TimerHandle handle = TimerWheelSchedule(wheel, .5, HandleTimer, 0);
+
+    ASSERT_TRUE(TimerWheelCancel(wheel, handle), "timer was not cancelled!");
+    TimerWheelAdvance(wheel, 1);
+
+    ASSERT_INT_EQUAL(0, fireCount, "cancelled timer fired!");
+}
+
+void TESTEXPORT CancelStaleHandleIsIgnored(TestContext *context) {
+    TimerHandle handle = TimerWheelSchedule(wheel, .01, HandleTimer, 0);
+    TimerWheelAdvance(wheel, .01);
+    // Reuses the fired timer's slot.
+    TimerWheelSchedule(wheel, .01, HandleTimer, 0);
+
+    ASSERT_FALSE(TimerWheelCancel(wheel, handle), "cancelled by a stale handle!");
+    ASSERT_INT_EQUAL(1, TimerWheelPending(wheel), "stale handle cancelled a live timer!");
+}
+
+void TESTEXPORT TimerCanRescheduleItself(TestContext *context) {
+    TimerWheelSchedule(wheel, .1, HandleRescheduleTimer, 0);
+    TimerWheelAdvance(wheel, 1);
+
+    ASSERT_INT_EQUAL(10, fireCount, "timer should have fired every tenth of a second!");
+}
+
+void TESTEXPORT TimerPollsClock(TestContext *context) {
+    fakeClock = 100;
+    TimerWheelSetClock(wheel, ReadFakeClock);
+    TimerWheelSchedule(wheel, .25, HandleTimer, 0);
+
+    fakeClock = 100.2;
+    TimerWheelPoll(wheel);
+    ASSERT_INT_EQUAL(0, fireCount, "timer fired early!");
+    fakeClock = 100.3;
+    TimerWheelPoll(wheel);
+    ASSERT_INT_EQUAL(1, fireCount, "timer did not fire!");
+}
+/// REGION END
+
+static void HandleTimer(void *data) {
+    fireCount++;
+    firedAt = TimerWheelNow(wheel);
+}
+
+static void HandleRescheduleTimer(void *data) {
+    fireCount++;
+    TimerWheelSchedule(wheel, .1, HandleRescheduleTimer, 0);
+}
+
+static double ReadFakeClock(void) {
+    return fakeClock;
+}
+
+static void InitTimerTest(TestContext *context) {
+    wheel = TimerWheelCreate(TICK);
+    fireCount = 0;
+    firedAt = -1;
+}
+
+static void CleanupTimerTest(TestContext *context) {
+    TimerWheelDispose(wheel);
+    wheel = 0;
+}
+
+BEGIN_MODULE_TEST(timer_wheel)
+    ADD_TEST(TimerFiresAfterDelay, InitTimerTest, CleanupTimerTest)
+    ADD_TEST(TimerFiresOnTimeAcrossLevels, InitTimerTest, CleanupTimerTest)
+    ADD_TEST(CancelledTimerDoesNotFire, InitTimerTest, CleanupTimerTest)
+    ADD_TEST(CancelStaleHandleIsIgnored, InitTimerTest, CleanupTimerTest)
+    ADD_TEST(TimerCanRescheduleItself, InitTimerTest, CleanupTimerTest)
+    ADD_TEST(TimerPollsClock, InitTimerTest, CleanupTimerTest)
+END_MODULE_TEST
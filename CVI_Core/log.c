@@ -1,32 +1,169 @@
+#include <windows.h>
+#include <ansi_c.h>
+#include <stdint.h>
+#include <utility.h>
 #include <toolbox.h>
 #include "log.h"
 
-static Log *globalLog;
+// Per thread, per log. Must be a power of two.
+#define LOG_BUFFER_SIZE 16384
+#define LOG_RECORD_MAX 512
+#define LOG_SINK_INTERVAL .01
+
+#define SINK_STOPPED 0
+#define SINK_RUNNING 1
+
+static Log *volatile globalLog;
+
+// Only the owning thread moves head and only the sink moves tail, so neither side waits on the other.
+typedef struct LogBuffer {
+    struct LogBuffer *next;
+    volatile LONG head;
+    volatile LONG tail;
+    volatile LONG dropped;
+    // Set once the owning thread has exited; the sink frees the buffer after draining it.
+    volatile LONG orphaned;
+    char data[LOG_BUFFER_SIZE];
+} LogBuffer;
 
-// TODO: this should all really be thread safe...
 struct Log {
+    // Guards userData and the sink; writers never take it.
+    CmtThreadLockHandle lock;
     HashTableType userData;
-    LogAssertHandler DoAssert;
+    volatile LogAssertHandler DoAssert;
+    CmtTLVHandle threadBuffer;
+    LogBuffer *volatile buffers;
+    LogSinkHandler sink;
+    void *sinkData;
+    FILE *sinkFile;
+    volatile LONG sinkState;
+    CmtThreadFunctionID sinkThread;
+};
+
+static const char *levelNames[] = {
+    [LogLevelDebug] = "DEBUG",
+    [LogLevelInfo] = "INFO",
+    [LogLevelWarning] = "WARNING",
+    [LogLevelError] = "ERROR"
 };
 
 static void HandleLogAssert(Log *log, int passed, char *fileName, int lineNumber, AssertReason reason, char *message) {
     DoAssert(passed, fileName, lineNumber, message);
 }
 
+static uint32_t LoadCounter(volatile LONG *value) {
+    return (uint32_t)InterlockedCompareExchange(value, 0, 0);
+}
+
+// Called with the lock held.
+static void Emit(Log *log, const char *records, size_t length) {
+    if (log->sink) {
+        log->sink(log, records, length, log->sinkData);
+    } else {
+        fwrite(records, 1, length, log->sinkFile ? log->sinkFile : stderr);
+    }
+}
+
+static void DrainBuffers(Log *log) {
+    CmtGetLock(log->lock);
+    LogBuffer *buffers = (LogBuffer *)InterlockedCompareExchangePointer((PVOID volatile *)&log->buffers, 0, 0);
+    LogBuffer *previous = 0;
+    for (LogBuffer *buffer = buffers, *next; buffer; buffer = next) {
+        next = buffer->next;
+        // Read before head, so an orphaned buffer is known to hold its thread's last record.
+        int orphaned = LoadCounter(&buffer->orphaned) != 0;
+        uint32_t dropped = (uint32_t)InterlockedExchange(&buffer->dropped, 0);
+        if (dropped) {
+            char note[64];
+            int length = sprintf(note, "[%s] %u log records dropped\n", levelNames[LogLevelWarning], dropped);
+            Emit(log, note, length);
+        }
+
+        uint32_t tail = LoadCounter(&buffer->tail);
+        uint32_t head = LoadCounter(&buffer->head);
+        while (tail != head) {
+            uint32_t offset = tail & (LOG_BUFFER_SIZE - 1);
+            uint32_t length = head - tail;
+            if (length > LOG_BUFFER_SIZE - offset) {
+                length = LOG_BUFFER_SIZE - offset;
+            }
+            Emit(log, buffer->data + offset, length);
+            tail += length;
+        }
+        InterlockedExchange(&buffer->tail, (LONG)tail);
+
+        // Writers only ever push onto the front of the list, so a buffer behind another can be
+        // unlinked directly; the front one only if no writer has pushed in front of it meanwhile.
+        if (orphaned && previous) {
+            previous->next = next;
+            free(buffer);
+        } else if (orphaned && InterlockedCompareExchangePointer((PVOID volatile *)&log->buffers, next, buffer) == buffer) {
+            free(buffer);
+        } else {
+            previous = buffer;
+        }
+    }
+    if (!log->sink) {
+        fflush(log->sinkFile ? log->sinkFile : stderr);
+    }
+    CmtReleaseLock(log->lock);
+}
+
+static int CVICALLBACK RunSink(void *data) {
+    Log *log = (Log *)data;
+    while (LoadCounter(&log->sinkState) == SINK_RUNNING) {
+        DrainBuffers(log);
+        Delay(LOG_SINK_INTERVAL);
+    }
+    return 0;
+}
+
+static void CVICALLBACK HandleThreadBufferDiscarded(void *threadLocalPtr, int event, void *callbackData, unsigned int threadID) {
+    LogBuffer *buffer = *(LogBuffer **)threadLocalPtr;
+    if (buffer) {
+        InterlockedExchange(&buffer->orphaned, 1);
+    }
+}
+
+static LogBuffer *GetThreadBuffer(Log *log) {
+    LogBuffer **slot;
+    CmtGetThreadLocalVar(log->threadBuffer, &slot);
+    if (*slot) {
+        return *slot;
+    }
+
+    // First record from this thread: link a buffer in for the sink and start the sink if needed.
+    LogBuffer *buffer = calloc(1, sizeof(LogBuffer));
+    do {
+        buffer->next = (LogBuffer *)InterlockedCompareExchangePointer((PVOID volatile *)&log->buffers, 0, 0);
+    } while (InterlockedCompareExchangePointer((PVOID volatile *)&log->buffers, buffer, buffer->next) != buffer->next);
+    *slot = buffer;
+
+    if (InterlockedCompareExchange(&log->sinkState, SINK_RUNNING, SINK_STOPPED) == SINK_STOPPED) {
+        CmtScheduleThreadPoolFunction(DEFAULT_THREAD_POOL_HANDLE, RunSink, log, &log->sinkThread);
+    }
+    return buffer;
+}
+
 Log *LogGetGlobal() {
-    return globalLog;
+    return (Log *)InterlockedCompareExchangePointer((PVOID volatile *)&globalLog, 0, 0);
 }
 
-void LogSetGlobal(Log *log) {
-    LogDispose(LogGetGlobal());
-    globalLog = log;
+Log *LogSetGlobal(Log *log) {
+    return (Log *)InterlockedExchangePointer((PVOID volatile *)&globalLog, log);
 }
 
 static Log *GetOrMakeGlobalLog() {
     Log *log = LogGetGlobal();
     if (!log) {
-        log = LogCreate();
-        LogSetGlobal(log);
+        // Another thread may get there first; keep whichever log won.
+        Log *created = LogCreate();
+        log = (Log *)InterlockedCompareExchangePointer((PVOID volatile *)&globalLog, created, 0);
+        if (log) {
+            LogDispose(created);
+        } else {
+            log = created;
+        }
     }
     return log;
 }
@@ -37,33 +174,67 @@ void LogGlobalAssert(int passed, char *fileName, int lineNumber, AssertReason re
 
 void LogSetPrivateData(Log *log, char *key, void *privateData) {
     LOG_ASSERT_REASON(log, ArgumentNullReason);
+    CmtGetLock(log->lock);
     if (!log->userData) {
         HashTableCreate(10, C_STRING_KEY, 0, sizeof(void *), &log->userData);
     }
-    
+
     HashTableInsertItem(log->userData, key, &privateData);
+    CmtReleaseLock(log->lock);
 }
 
 void *LogGetPrivateData(Log *log, char *key) {
     LOG_ASSERT_REASON(log && log->userData, ArgumentNullReason);
     void *data;
+    CmtGetLock(log->lock);
     HashTableGetItem(log->userData, key, &data, sizeof(data));
+    CmtReleaseLock(log->lock);
     return data;
 }
 
 void LogClearPrivateData(Log *log, char *key) {
     LOG_ASSERT_REASON(log && log->userData, ArgumentNullReason);
+    CmtGetLock(log->lock);
     HashTableRemoveItem(log->userData, key, 0, 0);
+    CmtReleaseLock(log->lock);
 }
 
 void LogSetAssertHandler(Log *log, LogAssertHandler handler) {
     LOG_ASSERT_REASON(log, ArgumentNullReason);
-    log->DoAssert = handler;
+    InterlockedExchangePointer((PVOID volatile *)&log->DoAssert, (PVOID)handler);
+}
+
+void LogSetSink(Log *log, LogSinkHandler sink, void *data) {
+    LOG_ASSERT_REASON(log, ArgumentNullReason);
+    CmtGetLock(log->lock);
+    log->sink = sink;
+    log->sinkData = data;
+    CmtReleaseLock(log->lock);
+}
+
+int LogSetSinkFile(Log *log, const char *path) {
+    LOG_ASSERT_REASON(log, ArgumentNullReason);
+    FILE *file = path ? fopen(path, "a") : 0;
+    if (path && !file) {
+        return 0;
+    }
+
+    CmtGetLock(log->lock);
+    if (log->sinkFile) {
+        fclose(log->sinkFile);
+    }
+    log->sinkFile = file;
+    log->sink = 0;
+    log->sinkData = 0;
+    CmtReleaseLock(log->lock);
+    return 1;
 }
 
 Log *LogCreate() {
     Log *log = calloc(1, sizeof(Log));
     log->DoAssert = HandleLogAssert;
+    CmtNewLock(0, 0, &log->lock);
+    CmtNewThreadLocalVar(sizeof(LogBuffer *), 0, HandleThreadBufferDiscarded, 0, &log->threadBuffer);
     return log;
 }
 
@@ -71,9 +242,25 @@ void LogDispose(Log *log) {
     if (!log) {
         return;
     }
-    if (log == LogGetGlobal()) {
-        globalLog = 0;
+    InterlockedCompareExchangePointer((PVOID volatile *)&globalLog, 0, log);
+
+    if (InterlockedExchange(&log->sinkState, SINK_STOPPED) == SINK_RUNNING) {
+        CmtWaitForThreadPoolFunctionCompletion(DEFAULT_THREAD_POOL_HANDLE, log->sinkThread, 0);
+        CmtReleaseThreadPoolFunctionID(DEFAULT_THREAD_POOL_HANDLE, log->sinkThread);
+    }
+    // Discarding runs the callback on every buffer still in use, so do it before they are freed.
+    CmtDiscardThreadLocalVar(log->threadBuffer);
+    DrainBuffers(log);
+    while (log->buffers) {
+        LogBuffer *next = log->buffers->next;
+        free(log->buffers);
+        log->buffers = next;
     }
+    if (log->sinkFile) {
+        fclose(log->sinkFile);
+    }
+
+    CmtDiscardLock(log->lock);
     HashTableDispose(log->userData);
     log->userData = 0;
     free(log);
@@ -82,3 +269,38 @@ void LogDispose(Log *log) {
 void LogAssert(Log *log, int passed, char *fileName, int lineNumber, AssertReason reason, char *message) {
     log->DoAssert(log, passed, fileName, lineNumber, reason, message);
 }
+
+void LogWrite(Log *log, LogLevel level, const char *format, ...) {
+    LOG_ASSERT_REASON(log && format, ArgumentNullReason);
+    LOG_ASSERT_REASON(level >= LogLevelDebug && level <= LogLevelError, ArgumentOutOfRangeReason);
+
+    char record[LOG_RECORD_MAX];
+    int length = sprintf(record, "[%s] ", levelNames[level]);
+    va_list args;
+    va_start(args, format);
+    // Leave room for the newline; long messages are cut short.
+    int written = vsnprintf(record + length, sizeof(record) - length - 1, format, args);
+    va_end(args);
+    if (written > 0) {
+        length += written < (int)sizeof(record) - length - 1 ? written : (int)sizeof(record) - length - 2;
+    }
+    record[length++] = '\n';
+
+    LogBuffer *buffer = GetThreadBuffer(log);
+    uint32_t head = LoadCounter(&buffer->head);
+    if (LOG_BUFFER_SIZE - (head - LoadCounter(&buffer->tail)) < (uint32_t)length) {
+        InterlockedIncrement(&buffer->dropped);
+        return;
+    }
+
+    uint32_t offset = head & (LOG_BUFFER_SIZE - 1);
+    uint32_t first = (uint32_t)length < LOG_BUFFER_SIZE - offset ? (uint32_t)length : LOG_BUFFER_SIZE - offset;
+    memcpy(buffer->data + offset, record, first);
+    memcpy(buffer->data, record + first, length - first);
+    InterlockedExchange(&buffer->head, (LONG)(head + length));
+}
+
+void LogFlush(Log *log) {
+    LOG_ASSERT_REASON(log, ArgumentNullReason);
+    DrainBuffers(log);
+}
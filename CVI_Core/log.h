@@ -8,6 +8,7 @@
 //==============================================================================
 // Include files
 
+#include <stddef.h>
 #include "cvidef.h"
       
 typedef enum AssertReason {
@@ -30,12 +31,24 @@ typedef enum AssertReason {
 #define LOG_ASSERTMSG_REASON(passed, msg, reason)
 #endif
         
+typedef enum LogLevel {
+    LogLevelDebug,
+    LogLevelInfo,
+    LogLevelWarning,
+    LogLevelError
+} LogLevel;
+
 typedef struct Log Log;        
       
 typedef void (*LogAssertHandler)(Log *, int, char *, int, AssertReason, char *);
+// Called on the log's sink thread with a batch of whole, newline terminated records. Records from
+// one thread stay in order; records from different threads are only ordered batch by batch.
+typedef void (*LogSinkHandler)(Log *, const char *records, size_t length, void *data);
 
 Log *LogGetGlobal();
-void LogSetGlobal(Log *log);
+// Returns the previous global log. Other threads may still be writing to it, so the caller
+// disposes it only once they are done.
+Log *LogSetGlobal(Log *log);
 void LogGlobalAssert(int passed, char *fileName, int lineNumber, AssertReason reason, char *message);
       
 Log *LogCreate();
@@ -47,8 +60,20 @@ void LogSetPrivateData(Log *log, char *key, void *privateData);
 void *LogGetPrivateData(Log *log, char *key);
 void LogClearPrivateData(Log *log, char *key);
 
+// Assert handlers run synchronously on the thread that asserted; only records go through the sink.
 void LogAssert(Log *log, int passed, char *fileName, int lineNumber, AssertReason reason, char *message);
 
+// Formats into the calling thread's own buffer and returns without taking a lock or making a
+// syscall. If a thread outruns the sink its records are dropped and counted rather than waiting.
+// A thread's buffer is freed once the thread has exited and the sink has written out what it left.
+void LogWrite(Log *log, LogLevel level, const char *format, ...);
+// Writes out everything logged so far, from every thread, before returning.
+void LogFlush(Log *log);
+// Records go to stderr until a sink or file is set.
+void LogSetSink(Log *log, LogSinkHandler sink, void *data);
+// Appends to the file at path, or goes back to stderr for a NULL path. Returns 0 if it can not open.
+int LogSetSinkFile(Log *log, const char *path);
+
 #ifdef __cplusplus
     }
 #endif
@@ -239,7 +239,8 @@ TestContext *CreateContext() {
     Log *log = LogCreate();
     LogSetAssertHandler(log, HandleTestLogAssert);
     LogSetPrivateData(log, LOG_CONTEXT_KEY, context);
-    LogSetGlobal(log);
+    // No tests are running yet, so nothing can still be writing to a log this replaces.
+    LogDispose(LogSetGlobal(log));
     context->data->log = log;
     
     return context;